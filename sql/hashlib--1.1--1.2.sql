@@ -0,0 +1,1032 @@
+-- functions are safe to run in parallel workers
+
+ALTER FUNCTION hash_string(text, text) PARALLEL SAFE;
+ALTER FUNCTION hash_string(bytea, text) PARALLEL SAFE;
+ALTER FUNCTION hash_string(text, text, int4) PARALLEL SAFE;
+ALTER FUNCTION hash_string(bytea, text, int4) PARALLEL SAFE;
+ALTER FUNCTION hash64_string(text, text) PARALLEL SAFE;
+ALTER FUNCTION hash64_string(bytea, text) PARALLEL SAFE;
+ALTER FUNCTION hash64_string(text, text, int8) PARALLEL SAFE;
+ALTER FUNCTION hash64_string(bytea, text, int8) PARALLEL SAFE;
+ALTER FUNCTION hash64_string(text, text, int8, int8) PARALLEL SAFE;
+ALTER FUNCTION hash64_string(bytea, text, int8, int8) PARALLEL SAFE;
+ALTER FUNCTION hash128_string(text, text) PARALLEL SAFE;
+ALTER FUNCTION hash128_string(bytea, text) PARALLEL SAFE;
+ALTER FUNCTION hash128_string(text, text, int8) PARALLEL SAFE;
+ALTER FUNCTION hash128_string(bytea, text, int8) PARALLEL SAFE;
+ALTER FUNCTION hash128_string(text, text, int8, int8) PARALLEL SAFE;
+ALTER FUNCTION hash128_string(bytea, text, int8, int8) PARALLEL SAFE;
+ALTER FUNCTION hash_int4(int4, text) PARALLEL SAFE;
+ALTER FUNCTION hash_int4(int8, text) PARALLEL SAFE;
+ALTER FUNCTION hash_int8(int8, text) PARALLEL SAFE;
+
+-- per-algorithm entry points, planner support rewrites calls to them
+
+CREATE OR REPLACE FUNCTION hashlib_lookup2(bytea) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_lookup2' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib64_lookup2(bytea) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_lookup2' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib128_lookup2(bytea) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_lookup2' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_lookup3(bytea) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_lookup3' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib64_lookup3(bytea) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_lookup3' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib128_lookup3(bytea) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_lookup3' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_lookup3le(bytea) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_lookup3le' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib64_lookup3le(bytea) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_lookup3le' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib128_lookup3le(bytea) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_lookup3le' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_lookup3be(bytea) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_lookup3be' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib64_lookup3be(bytea) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_lookup3be' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib128_lookup3be(bytea) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_lookup3be' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_siphash24(bytea) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_siphash24' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib64_siphash24(bytea) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_siphash24' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib128_siphash24(bytea) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_siphash24' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_siphash24_128(bytea) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_siphash24_128' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib64_siphash24_128(bytea) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_siphash24_128' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib128_siphash24_128(bytea) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_siphash24_128' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_siphash13(bytea) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_siphash13' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib64_siphash13(bytea) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_siphash13' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib128_siphash13(bytea) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_siphash13' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_halfsiphash13(bytea) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_halfsiphash13' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib64_halfsiphash13(bytea) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_halfsiphash13' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib128_halfsiphash13(bytea) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_halfsiphash13' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_murmur3(bytea) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_murmur3' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib64_murmur3(bytea) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_murmur3' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib128_murmur3(bytea) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_murmur3' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_murmur3_128(bytea) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_murmur3_128' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib64_murmur3_128(bytea) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_murmur3_128' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib128_murmur3_128(bytea) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_murmur3_128' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_murmur3_x86_128(bytea) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_murmur3_x86_128' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib64_murmur3_x86_128(bytea) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_murmur3_x86_128' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib128_murmur3_x86_128(bytea) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_murmur3_x86_128' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_city64(bytea) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_city64' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib64_city64(bytea) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_city64' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib128_city64(bytea) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_city64' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_city128(bytea) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_city128' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib64_city128(bytea) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_city128' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib128_city128(bytea) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_city128' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_citycrc128(bytea) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_citycrc128' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib64_citycrc128(bytea) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_citycrc128' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib128_citycrc128(bytea) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_citycrc128' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_citycrc256(bytea) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_citycrc256' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib64_citycrc256(bytea) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_citycrc256' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib128_citycrc256(bytea) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_citycrc256' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_spooky(bytea) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_spooky' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib64_spooky(bytea) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_spooky' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib128_spooky(bytea) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_spooky' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_pgsql84(bytea) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_pgsql84' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib64_pgsql84(bytea) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_pgsql84' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib128_pgsql84(bytea) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_pgsql84' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_md5(bytea) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_md5' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib64_md5(bytea) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_md5' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib128_md5(bytea) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_md5' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_crc32(bytea) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_crc32' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib64_crc32(bytea) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_crc32' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib128_crc32(bytea) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_crc32' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_crc32c(bytea) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_crc32c' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib64_crc32c(bytea) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_crc32c' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib128_crc32c(bytea) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_crc32c' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_xxh64(bytea) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_xxh64' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib64_xxh64(bytea) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_xxh64' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib128_xxh64(bytea) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_xxh64' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_xxh3_64(bytea) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_xxh3_64' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib64_xxh3_64(bytea) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_xxh3_64' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib128_xxh3_64(bytea) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_xxh3_64' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_xxh3_128(bytea) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_xxh3_128' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib64_xxh3_128(bytea) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_xxh3_128' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib128_xxh3_128(bytea) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_xxh3_128' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_int4_wang32(int4) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_int32_wang32' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_int4_wang32(int8) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_int32from64_wang32' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_int4_wang32mult(int4) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_int32_wang32mult' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_int4_wang32mult(int8) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_int32from64_wang32mult' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_int4_jenkins(int4) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_int32_jenkins' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_int4_jenkins(int8) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_int32from64_jenkins' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_int8_wang64(int8) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash_int64_wang64' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_int8_wang64to32(int8) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash_int64_wang64to32' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_support(internal) RETURNS internal
+	AS '$libdir/hashlib', 'pg_hashlib_support' LANGUAGE C STRICT;
+
+-- SUPPORT clause exists only in PostgreSQL 12+
+DO $$
+BEGIN
+	IF current_setting('server_version_num')::int >= 120000 THEN
+		EXECUTE 'ALTER FUNCTION hash_string(text, text) SUPPORT hashlib_support';
+		EXECUTE 'ALTER FUNCTION hash_string(bytea, text) SUPPORT hashlib_support';
+		EXECUTE 'ALTER FUNCTION hash_string(text, text, int4) SUPPORT hashlib_support';
+		EXECUTE 'ALTER FUNCTION hash_string(bytea, text, int4) SUPPORT hashlib_support';
+		EXECUTE 'ALTER FUNCTION hash64_string(text, text) SUPPORT hashlib_support';
+		EXECUTE 'ALTER FUNCTION hash64_string(bytea, text) SUPPORT hashlib_support';
+		EXECUTE 'ALTER FUNCTION hash64_string(text, text, int8) SUPPORT hashlib_support';
+		EXECUTE 'ALTER FUNCTION hash64_string(bytea, text, int8) SUPPORT hashlib_support';
+		EXECUTE 'ALTER FUNCTION hash64_string(text, text, int8, int8) SUPPORT hashlib_support';
+		EXECUTE 'ALTER FUNCTION hash64_string(bytea, text, int8, int8) SUPPORT hashlib_support';
+		EXECUTE 'ALTER FUNCTION hash128_string(text, text) SUPPORT hashlib_support';
+		EXECUTE 'ALTER FUNCTION hash128_string(bytea, text) SUPPORT hashlib_support';
+		EXECUTE 'ALTER FUNCTION hash128_string(text, text, int8) SUPPORT hashlib_support';
+		EXECUTE 'ALTER FUNCTION hash128_string(bytea, text, int8) SUPPORT hashlib_support';
+		EXECUTE 'ALTER FUNCTION hash128_string(text, text, int8, int8) SUPPORT hashlib_support';
+		EXECUTE 'ALTER FUNCTION hash128_string(bytea, text, int8, int8) SUPPORT hashlib_support';
+		EXECUTE 'ALTER FUNCTION hash_int4(int4, text) SUPPORT hashlib_support';
+		EXECUTE 'ALTER FUNCTION hash_int4(int8, text) SUPPORT hashlib_support';
+		EXECUTE 'ALTER FUNCTION hash_int8(int8, text) SUPPORT hashlib_support';
+	END IF;
+END
+$$;
+
+-- array variants
+
+CREATE OR REPLACE FUNCTION hash_string(text[], text) RETURNS int4[]
+	AS '$libdir/hashlib', 'pg_hash_string_array' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash_string(bytea[], text) RETURNS int4[]
+	AS '$libdir/hashlib', 'pg_hash_string_array' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash_string(text[], text, int4) RETURNS int4[]
+	AS '$libdir/hashlib', 'pg_hash_string_array' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash_string(bytea[], text, int4) RETURNS int4[]
+	AS '$libdir/hashlib', 'pg_hash_string_array' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash64_string(text[], text) RETURNS int8[]
+	AS '$libdir/hashlib', 'pg_hash64_string_array' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash64_string(bytea[], text) RETURNS int8[]
+	AS '$libdir/hashlib', 'pg_hash64_string_array' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash64_string(text[], text, int8) RETURNS int8[]
+	AS '$libdir/hashlib', 'pg_hash64_string_array' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash64_string(bytea[], text, int8) RETURNS int8[]
+	AS '$libdir/hashlib', 'pg_hash64_string_array' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash64_string(text[], text, int8, int8) RETURNS int8[]
+	AS '$libdir/hashlib', 'pg_hash64_string_array' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash64_string(bytea[], text, int8, int8) RETURNS int8[]
+	AS '$libdir/hashlib', 'pg_hash64_string_array' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash128_string(text[], text) RETURNS bytea[]
+	AS '$libdir/hashlib', 'pg_hash128_string_array' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash128_string(bytea[], text) RETURNS bytea[]
+	AS '$libdir/hashlib', 'pg_hash128_string_array' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash128_string(text[], text, int8) RETURNS bytea[]
+	AS '$libdir/hashlib', 'pg_hash128_string_array' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash128_string(bytea[], text, int8) RETURNS bytea[]
+	AS '$libdir/hashlib', 'pg_hash128_string_array' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash128_string(text[], text, int8, int8) RETURNS bytea[]
+	AS '$libdir/hashlib', 'pg_hash128_string_array' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash128_string(bytea[], text, int8, int8) RETURNS bytea[]
+	AS '$libdir/hashlib', 'pg_hash128_string_array' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+-- order-independent fingerprint
+
+CREATE OR REPLACE FUNCTION hashlib_fingerprint_transfn(internal, text, text) RETURNS internal
+	AS '$libdir/hashlib', 'pg_fingerprint_transfn' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_fingerprint_transfn(internal, bytea, text) RETURNS internal
+	AS '$libdir/hashlib', 'pg_fingerprint_transfn' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_fingerprint_combine(internal, internal) RETURNS internal
+	AS '$libdir/hashlib', 'pg_fingerprint_combine' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_fingerprint_serial(internal) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_fingerprint_serial' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_fingerprint_deserial(bytea, internal) RETURNS internal
+	AS '$libdir/hashlib', 'pg_fingerprint_deserial' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_fingerprint_final(internal) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_fingerprint_final' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE AGGREGATE hashlib_fingerprint(text, text) (
+	SFUNC = hashlib_fingerprint_transfn,
+	STYPE = internal,
+	FINALFUNC = hashlib_fingerprint_final,
+	COMBINEFUNC = hashlib_fingerprint_combine,
+	SERIALFUNC = hashlib_fingerprint_serial,
+	DESERIALFUNC = hashlib_fingerprint_deserial,
+	PARALLEL = SAFE
+);
+
+CREATE AGGREGATE hashlib_fingerprint(bytea, text) (
+	SFUNC = hashlib_fingerprint_transfn,
+	STYPE = internal,
+	FINALFUNC = hashlib_fingerprint_final,
+	COMBINEFUNC = hashlib_fingerprint_combine,
+	SERIALFUNC = hashlib_fingerprint_serial,
+	DESERIALFUNC = hashlib_fingerprint_deserial,
+	PARALLEL = SAFE
+);
+
+-- order-dependent streaming hash
+
+CREATE OR REPLACE FUNCTION hash_string_agg_transfn(internal, text, text) RETURNS internal
+	AS '$libdir/hashlib', 'pg_hash_agg_transfn' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash_string_agg_transfn(internal, bytea, text) RETURNS internal
+	AS '$libdir/hashlib', 'pg_hash_agg_transfn' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash_string_agg_transfn(internal, text, text, int4) RETURNS internal
+	AS '$libdir/hashlib', 'pg_hash_agg_transfn' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash_string_agg_transfn(internal, bytea, text, int4) RETURNS internal
+	AS '$libdir/hashlib', 'pg_hash_agg_transfn' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash_string_agg_transfn(internal, text, text, int8) RETURNS internal
+	AS '$libdir/hashlib', 'pg_hash_agg_transfn' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash_string_agg_transfn(internal, bytea, text, int8) RETURNS internal
+	AS '$libdir/hashlib', 'pg_hash_agg_transfn' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash_string_agg_final(internal) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_agg_final32' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash64_string_agg_final(internal) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash_agg_final64' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash128_string_agg_final(internal) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash_agg_final128' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE AGGREGATE hash_string_agg(text, text) (
+	SFUNC = hash_string_agg_transfn,
+	STYPE = internal,
+	FINALFUNC = hash_string_agg_final,
+	PARALLEL = SAFE
+);
+
+CREATE AGGREGATE hash_string_agg(bytea, text) (
+	SFUNC = hash_string_agg_transfn,
+	STYPE = internal,
+	FINALFUNC = hash_string_agg_final,
+	PARALLEL = SAFE
+);
+
+CREATE AGGREGATE hash_string_agg(text, text, int4) (
+	SFUNC = hash_string_agg_transfn,
+	STYPE = internal,
+	FINALFUNC = hash_string_agg_final,
+	PARALLEL = SAFE
+);
+
+CREATE AGGREGATE hash_string_agg(bytea, text, int4) (
+	SFUNC = hash_string_agg_transfn,
+	STYPE = internal,
+	FINALFUNC = hash_string_agg_final,
+	PARALLEL = SAFE
+);
+
+CREATE AGGREGATE hash64_string_agg(text, text) (
+	SFUNC = hash_string_agg_transfn,
+	STYPE = internal,
+	FINALFUNC = hash64_string_agg_final,
+	PARALLEL = SAFE
+);
+
+CREATE AGGREGATE hash64_string_agg(bytea, text) (
+	SFUNC = hash_string_agg_transfn,
+	STYPE = internal,
+	FINALFUNC = hash64_string_agg_final,
+	PARALLEL = SAFE
+);
+
+CREATE AGGREGATE hash64_string_agg(text, text, int8) (
+	SFUNC = hash_string_agg_transfn,
+	STYPE = internal,
+	FINALFUNC = hash64_string_agg_final,
+	PARALLEL = SAFE
+);
+
+CREATE AGGREGATE hash64_string_agg(bytea, text, int8) (
+	SFUNC = hash_string_agg_transfn,
+	STYPE = internal,
+	FINALFUNC = hash64_string_agg_final,
+	PARALLEL = SAFE
+);
+
+CREATE AGGREGATE hash128_string_agg(text, text) (
+	SFUNC = hash_string_agg_transfn,
+	STYPE = internal,
+	FINALFUNC = hash128_string_agg_final,
+	PARALLEL = SAFE
+);
+
+CREATE AGGREGATE hash128_string_agg(bytea, text) (
+	SFUNC = hash_string_agg_transfn,
+	STYPE = internal,
+	FINALFUNC = hash128_string_agg_final,
+	PARALLEL = SAFE
+);
+
+CREATE AGGREGATE hash128_string_agg(text, text, int8) (
+	SFUNC = hash_string_agg_transfn,
+	STYPE = internal,
+	FINALFUNC = hash128_string_agg_final,
+	PARALLEL = SAFE
+);
+
+CREATE AGGREGATE hash128_string_agg(bytea, text, int8) (
+	SFUNC = hash_string_agg_transfn,
+	STYPE = internal,
+	FINALFUNC = hash128_string_agg_final,
+	PARALLEL = SAFE
+);
+
+-- large objects, read in pieces without loading into memory
+CREATE OR REPLACE FUNCTION hash_lo(oid, text) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_lo' LANGUAGE C STABLE STRICT PARALLEL RESTRICTED;
+
+CREATE OR REPLACE FUNCTION hash_lo(oid, text, int4) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_lo' LANGUAGE C STABLE STRICT PARALLEL RESTRICTED;
+
+CREATE OR REPLACE FUNCTION hash64_lo(oid, text) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_lo' LANGUAGE C STABLE STRICT PARALLEL RESTRICTED;
+
+CREATE OR REPLACE FUNCTION hash64_lo(oid, text, int8) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_lo' LANGUAGE C STABLE STRICT PARALLEL RESTRICTED;
+
+CREATE OR REPLACE FUNCTION hash64_lo(oid, text, int8, int8) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_lo' LANGUAGE C STABLE STRICT PARALLEL RESTRICTED;
+
+CREATE OR REPLACE FUNCTION hash128_lo(oid, text) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_lo' LANGUAGE C STABLE STRICT PARALLEL RESTRICTED;
+
+CREATE OR REPLACE FUNCTION hash128_lo(oid, text, int8) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_lo' LANGUAGE C STABLE STRICT PARALLEL RESTRICTED;
+
+CREATE OR REPLACE FUNCTION hash128_lo(oid, text, int8, int8) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_lo' LANGUAGE C STABLE STRICT PARALLEL RESTRICTED;
+
+-- values of any type, hashed from stable binary encoding
+CREATE OR REPLACE FUNCTION hash_any(anyelement, text) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_any' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash64_any(anyelement, text) RETURNS int8
+	AS '$libdir/hashlib', 'pg_hash64_any' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash128_any(anyelement, text) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash128_any' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+-- bloom filter
+CREATE TYPE hashlib_bloom;
+
+CREATE OR REPLACE FUNCTION hashlib_bloom_in(cstring) RETURNS hashlib_bloom
+	AS '$libdir/hashlib', 'pg_bloom_in' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_bloom_out(hashlib_bloom) RETURNS cstring
+	AS '$libdir/hashlib', 'pg_bloom_out' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_bloom_recv(internal) RETURNS hashlib_bloom
+	AS '$libdir/hashlib', 'pg_bloom_recv' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_bloom_send(hashlib_bloom) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_bloom_send' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE TYPE hashlib_bloom (
+	INPUT = hashlib_bloom_in,
+	OUTPUT = hashlib_bloom_out,
+	RECEIVE = hashlib_bloom_recv,
+	SEND = hashlib_bloom_send,
+	STORAGE = extended
+);
+
+CREATE OR REPLACE FUNCTION bloom_agg_transfn(hashlib_bloom, text, int8, float8) RETURNS hashlib_bloom
+	AS '$libdir/hashlib', 'pg_bloom_agg_transfn' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION bloom_agg_transfn(hashlib_bloom, bytea, int8, float8) RETURNS hashlib_bloom
+	AS '$libdir/hashlib', 'pg_bloom_agg_transfn' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION bloom_agg_transfn(hashlib_bloom, text, int8, float8, text) RETURNS hashlib_bloom
+	AS '$libdir/hashlib', 'pg_bloom_agg_transfn' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION bloom_agg_transfn(hashlib_bloom, bytea, int8, float8, text) RETURNS hashlib_bloom
+	AS '$libdir/hashlib', 'pg_bloom_agg_transfn' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION bloom_union(hashlib_bloom, hashlib_bloom) RETURNS hashlib_bloom
+	AS '$libdir/hashlib', 'pg_bloom_union' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION bloom_contains(hashlib_bloom, text) RETURNS bool
+	AS '$libdir/hashlib', 'pg_bloom_contains' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION bloom_contains(hashlib_bloom, bytea) RETURNS bool
+	AS '$libdir/hashlib', 'pg_bloom_contains' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE bloom_agg(text, int8, float8) (
+	SFUNC = bloom_agg_transfn,
+	STYPE = hashlib_bloom,
+	COMBINEFUNC = bloom_union,
+	PARALLEL = SAFE
+);
+
+CREATE AGGREGATE bloom_agg(bytea, int8, float8) (
+	SFUNC = bloom_agg_transfn,
+	STYPE = hashlib_bloom,
+	COMBINEFUNC = bloom_union,
+	PARALLEL = SAFE
+);
+
+CREATE AGGREGATE bloom_agg(text, int8, float8, text) (
+	SFUNC = bloom_agg_transfn,
+	STYPE = hashlib_bloom,
+	COMBINEFUNC = bloom_union,
+	PARALLEL = SAFE
+);
+
+CREATE AGGREGATE bloom_agg(bytea, int8, float8, text) (
+	SFUNC = bloom_agg_transfn,
+	STYPE = hashlib_bloom,
+	COMBINEFUNC = bloom_union,
+	PARALLEL = SAFE
+);
+
+CREATE OPERATOR @> (
+	LEFTARG = hashlib_bloom,
+	RIGHTARG = text,
+	PROCEDURE = bloom_contains
+);
+
+CREATE OPERATOR @> (
+	LEFTARG = hashlib_bloom,
+	RIGHTARG = bytea,
+	PROCEDURE = bloom_contains
+);
+
+CREATE OPERATOR | (
+	LEFTARG = hashlib_bloom,
+	RIGHTARG = hashlib_bloom,
+	PROCEDURE = bloom_union,
+	COMMUTATOR = |
+);
+
+-- hyperloglog
+CREATE TYPE hll;
+
+CREATE OR REPLACE FUNCTION hll_in(cstring) RETURNS hll
+	AS '$libdir/hashlib', 'pg_hll_in' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hll_out(hll) RETURNS cstring
+	AS '$libdir/hashlib', 'pg_hll_out' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hll_recv(internal) RETURNS hll
+	AS '$libdir/hashlib', 'pg_hll_recv' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hll_send(hll) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hll_send' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE TYPE hll (
+	INPUT = hll_in,
+	OUTPUT = hll_out,
+	RECEIVE = hll_recv,
+	SEND = hll_send,
+	STORAGE = extended
+);
+
+CREATE OR REPLACE FUNCTION hll_union(hll, hll) RETURNS hll
+	AS '$libdir/hashlib', 'pg_hll_union' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hll_cardinality(hll) RETURNS float8
+	AS '$libdir/hashlib', 'pg_hll_cardinality' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hll_add_transfn(internal, text, text, int4) RETURNS internal
+	AS '$libdir/hashlib', 'pg_hll_add_transfn' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hll_add_transfn(internal, bytea, text, int4) RETURNS internal
+	AS '$libdir/hashlib', 'pg_hll_add_transfn' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hll_union_transfn(internal, hll) RETURNS internal
+	AS '$libdir/hashlib', 'pg_hll_union_transfn' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hll_combine(internal, internal) RETURNS internal
+	AS '$libdir/hashlib', 'pg_hll_combine' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hll_serial(internal) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hll_serial' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hll_deserial(bytea, internal) RETURNS internal
+	AS '$libdir/hashlib', 'pg_hll_deserial' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hll_final(internal) RETURNS hll
+	AS '$libdir/hashlib', 'pg_hll_final' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE AGGREGATE hll_add_agg(text, text, int4) (
+	SFUNC = hll_add_transfn,
+	STYPE = internal,
+	FINALFUNC = hll_final,
+	COMBINEFUNC = hll_combine,
+	SERIALFUNC = hll_serial,
+	DESERIALFUNC = hll_deserial,
+	PARALLEL = SAFE
+);
+
+CREATE AGGREGATE hll_add_agg(bytea, text, int4) (
+	SFUNC = hll_add_transfn,
+	STYPE = internal,
+	FINALFUNC = hll_final,
+	COMBINEFUNC = hll_combine,
+	SERIALFUNC = hll_serial,
+	DESERIALFUNC = hll_deserial,
+	PARALLEL = SAFE
+);
+
+CREATE AGGREGATE hll_union_agg(hll) (
+	SFUNC = hll_union_transfn,
+	STYPE = internal,
+	FINALFUNC = hll_final,
+	COMBINEFUNC = hll_combine,
+	SERIALFUNC = hll_serial,
+	DESERIALFUNC = hll_deserial,
+	PARALLEL = SAFE
+);
+
+-- minhash signatures for near-duplicate detection
+
+CREATE OR REPLACE FUNCTION minhash_agg_transfn(internal, text, int4, text) RETURNS internal
+	AS '$libdir/hashlib', 'pg_minhash_transfn' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION minhash_agg_transfn(internal, bytea, int4, text) RETURNS internal
+	AS '$libdir/hashlib', 'pg_minhash_transfn' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION minhash_agg_combine(internal, internal) RETURNS internal
+	AS '$libdir/hashlib', 'pg_minhash_combine' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION minhash_agg_serial(internal) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_minhash_serial' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION minhash_agg_deserial(bytea, internal) RETURNS internal
+	AS '$libdir/hashlib', 'pg_minhash_deserial' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION minhash_agg_final(internal) RETURNS int8[]
+	AS '$libdir/hashlib', 'pg_minhash_final' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE AGGREGATE minhash_agg(text, int4, text) (
+	SFUNC = minhash_agg_transfn,
+	STYPE = internal,
+	FINALFUNC = minhash_agg_final,
+	COMBINEFUNC = minhash_agg_combine,
+	SERIALFUNC = minhash_agg_serial,
+	DESERIALFUNC = minhash_agg_deserial,
+	PARALLEL = SAFE
+);
+
+CREATE AGGREGATE minhash_agg(bytea, int4, text) (
+	SFUNC = minhash_agg_transfn,
+	STYPE = internal,
+	FINALFUNC = minhash_agg_final,
+	COMBINEFUNC = minhash_agg_combine,
+	SERIALFUNC = minhash_agg_serial,
+	DESERIALFUNC = minhash_agg_deserial,
+	PARALLEL = SAFE
+);
+
+CREATE OR REPLACE FUNCTION minhash(text[], int4) RETURNS int8[]
+	AS '$libdir/hashlib', 'pg_minhash_array' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION minhash(text[], int4, text) RETURNS int8[]
+	AS '$libdir/hashlib', 'pg_minhash_array' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION minhash(bytea[], int4) RETURNS int8[]
+	AS '$libdir/hashlib', 'pg_minhash_array' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION minhash(bytea[], int4, text) RETURNS int8[]
+	AS '$libdir/hashlib', 'pg_minhash_array' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION minhash_similarity(int8[], int8[]) RETURNS float8
+	AS '$libdir/hashlib', 'pg_minhash_similarity' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION minhash_bands(int8[], int4, int4) RETURNS int8[]
+	AS '$libdir/hashlib', 'pg_minhash_bands' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+-- count-min sketch
+
+CREATE TYPE cms;
+
+CREATE OR REPLACE FUNCTION cms_in(cstring) RETURNS cms
+	AS '$libdir/hashlib', 'pg_cms_in' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION cms_out(cms) RETURNS cstring
+	AS '$libdir/hashlib', 'pg_cms_out' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION cms_recv(internal) RETURNS cms
+	AS '$libdir/hashlib', 'pg_cms_recv' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION cms_send(cms) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_cms_send' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE TYPE cms (
+	INPUT = cms_in,
+	OUTPUT = cms_out,
+	RECEIVE = cms_recv,
+	SEND = cms_send,
+	STORAGE = extended
+);
+
+CREATE OR REPLACE FUNCTION cms_union(cms, cms) RETURNS cms
+	AS '$libdir/hashlib', 'pg_cms_union' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION cms_estimate(cms, text) RETURNS int8
+	AS '$libdir/hashlib', 'pg_cms_estimate' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION cms_estimate(cms, bytea) RETURNS int8
+	AS '$libdir/hashlib', 'pg_cms_estimate' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION cms_top(cms, OUT value text, OUT estimate int8) RETURNS SETOF record
+	AS '$libdir/hashlib', 'pg_cms_top' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION cms_add_transfn(internal, text, int4, int4) RETURNS internal
+	AS '$libdir/hashlib', 'pg_cms_add_transfn' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION cms_add_transfn(internal, text, int4, int4, text) RETURNS internal
+	AS '$libdir/hashlib', 'pg_cms_add_transfn' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION cms_add_transfn(internal, text, int4, int4, text, int4) RETURNS internal
+	AS '$libdir/hashlib', 'pg_cms_add_transfn' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION cms_add_transfn(internal, bytea, int4, int4) RETURNS internal
+	AS '$libdir/hashlib', 'pg_cms_add_transfn' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION cms_add_transfn(internal, bytea, int4, int4, text) RETURNS internal
+	AS '$libdir/hashlib', 'pg_cms_add_transfn' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION cms_add_transfn(internal, bytea, int4, int4, text, int4) RETURNS internal
+	AS '$libdir/hashlib', 'pg_cms_add_transfn' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION cms_combine(internal, internal) RETURNS internal
+	AS '$libdir/hashlib', 'pg_cms_combine' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION cms_serial(internal) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_cms_serial' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION cms_deserial(bytea, internal) RETURNS internal
+	AS '$libdir/hashlib', 'pg_cms_deserial' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION cms_final(internal) RETURNS cms
+	AS '$libdir/hashlib', 'pg_cms_final' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE AGGREGATE cms_agg(text, int4, int4) (
+	SFUNC = cms_add_transfn,
+	STYPE = internal,
+	FINALFUNC = cms_final,
+	COMBINEFUNC = cms_combine,
+	SERIALFUNC = cms_serial,
+	DESERIALFUNC = cms_deserial,
+	PARALLEL = SAFE
+);
+
+CREATE AGGREGATE cms_agg(text, int4, int4, text) (
+	SFUNC = cms_add_transfn,
+	STYPE = internal,
+	FINALFUNC = cms_final,
+	COMBINEFUNC = cms_combine,
+	SERIALFUNC = cms_serial,
+	DESERIALFUNC = cms_deserial,
+	PARALLEL = SAFE
+);
+
+CREATE AGGREGATE cms_agg(text, int4, int4, text, int4) (
+	SFUNC = cms_add_transfn,
+	STYPE = internal,
+	FINALFUNC = cms_final,
+	COMBINEFUNC = cms_combine,
+	SERIALFUNC = cms_serial,
+	DESERIALFUNC = cms_deserial,
+	PARALLEL = SAFE
+);
+
+CREATE AGGREGATE cms_agg(bytea, int4, int4) (
+	SFUNC = cms_add_transfn,
+	STYPE = internal,
+	FINALFUNC = cms_final,
+	COMBINEFUNC = cms_combine,
+	SERIALFUNC = cms_serial,
+	DESERIALFUNC = cms_deserial,
+	PARALLEL = SAFE
+);
+
+CREATE AGGREGATE cms_agg(bytea, int4, int4, text) (
+	SFUNC = cms_add_transfn,
+	STYPE = internal,
+	FINALFUNC = cms_final,
+	COMBINEFUNC = cms_combine,
+	SERIALFUNC = cms_serial,
+	DESERIALFUNC = cms_deserial,
+	PARALLEL = SAFE
+);
+
+CREATE AGGREGATE cms_agg(bytea, int4, int4, text, int4) (
+	SFUNC = cms_add_transfn,
+	STYPE = internal,
+	FINALFUNC = cms_final,
+	COMBINEFUNC = cms_combine,
+	SERIALFUNC = cms_serial,
+	DESERIALFUNC = cms_deserial,
+	PARALLEL = SAFE
+);
+
+-- jump consistent hash
+
+CREATE OR REPLACE FUNCTION jump_hash(int8, int4) RETURNS int4
+	AS '$libdir/hashlib', 'pg_jump_hash' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION jump_hash_string(text, text, int4) RETURNS int4
+	AS '$libdir/hashlib', 'pg_jump_hash_string' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION jump_hash_string(bytea, text, int4) RETURNS int4
+	AS '$libdir/hashlib', 'pg_jump_hash_string' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION jump_hash_moves(first_key int8, last_key int8, old_buckets int4, new_buckets int4,
+	OUT key int8, OUT old_bucket int4, OUT new_bucket int4) RETURNS SETOF record
+	AS '$libdir/hashlib', 'pg_jump_hash_moves' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+-- rendezvous hashing, weights may be NULL
+
+CREATE OR REPLACE FUNCTION rendezvous_pick(text, text[], text) RETURNS text
+	AS '$libdir/hashlib', 'pg_rendezvous_pick' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION rendezvous_pick(text, text[], float8[], text) RETURNS text
+	AS '$libdir/hashlib', 'pg_rendezvous_pick' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION rendezvous_pick(bytea, text[], text) RETURNS text
+	AS '$libdir/hashlib', 'pg_rendezvous_pick' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION rendezvous_pick(bytea, text[], float8[], text) RETURNS text
+	AS '$libdir/hashlib', 'pg_rendezvous_pick' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION rendezvous_top(text, text[], int4, text) RETURNS text[]
+	AS '$libdir/hashlib', 'pg_rendezvous_top' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION rendezvous_top(text, text[], float8[], int4, text) RETURNS text[]
+	AS '$libdir/hashlib', 'pg_rendezvous_top' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION rendezvous_top(bytea, text[], int4, text) RETURNS text[]
+	AS '$libdir/hashlib', 'pg_rendezvous_top' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION rendezvous_top(bytea, text[], float8[], int4, text) RETURNS text[]
+	AS '$libdir/hashlib', 'pg_rendezvous_top' LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+-- consistent hash ring
+
+CREATE TYPE hashlib_ring;
+
+CREATE OR REPLACE FUNCTION hashlib_ring_in(cstring) RETURNS hashlib_ring
+	AS '$libdir/hashlib', 'pg_ring_in' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_ring_out(hashlib_ring) RETURNS cstring
+	AS '$libdir/hashlib', 'pg_ring_out' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_ring_recv(internal) RETURNS hashlib_ring
+	AS '$libdir/hashlib', 'pg_ring_recv' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_ring_send(hashlib_ring) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_ring_send' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE TYPE hashlib_ring (
+	INPUT = hashlib_ring_in,
+	OUTPUT = hashlib_ring_out,
+	RECEIVE = hashlib_ring_recv,
+	SEND = hashlib_ring_send,
+	STORAGE = extended
+);
+
+CREATE OR REPLACE FUNCTION ring_build(text[], int4, text) RETURNS hashlib_ring
+	AS '$libdir/hashlib', 'pg_ring_build' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION ring_lookup(hashlib_ring, text) RETURNS text
+	AS '$libdir/hashlib', 'pg_ring_lookup' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION ring_lookup(hashlib_ring, bytea) RETURNS text
+	AS '$libdir/hashlib', 'pg_ring_lookup' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION ring_assign(hashlib_ring, text[], float8) RETURNS text[]
+	AS '$libdir/hashlib', 'pg_ring_assign' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION ring_assign(hashlib_ring, bytea[], float8) RETURNS text[]
+	AS '$libdir/hashlib', 'pg_ring_assign' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+-- hash to bucket without modulo
+
+CREATE OR REPLACE FUNCTION hash_bucket(text, text, int4) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_bucket' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash_bucket(bytea, text, int4) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_bucket' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash_int_bucket(int8, text, int4) RETURNS int4
+	AS '$libdir/hashlib', 'pg_hash_int_bucket' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+-- hash operator classes
+
+CREATE OR REPLACE FUNCTION hashlib_hashtext_city64(text) RETURNS int4
+	AS '$libdir/hashlib', 'pg_opclass_hash_city64' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_hashtext_city64_extended(text, int8) RETURNS int8
+	AS '$libdir/hashlib', 'pg_opclass_hash_extended_city64' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_hashbytea_murmur3(bytea) RETURNS int4
+	AS '$libdir/hashlib', 'pg_opclass_hash_murmur3' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_hashbytea_murmur3_extended(bytea, int8) RETURNS int8
+	AS '$libdir/hashlib', 'pg_opclass_hash_extended_murmur3' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_hashint8_wang64(int8) RETURNS int4
+	AS '$libdir/hashlib', 'pg_opclass_hash_int64_wang64' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hashlib_hashint8_wang64_extended(int8, int8) RETURNS int8
+	AS '$libdir/hashlib', 'pg_opclass_hash_extended_int64_wang64' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OPERATOR CLASS text_city64_ops FOR TYPE text USING hash AS
+	OPERATOR 1 = (text, text),
+	FUNCTION 1 hashlib_hashtext_city64(text);
+
+CREATE OPERATOR CLASS bytea_murmur3_ops FOR TYPE bytea USING hash AS
+	OPERATOR 1 = (bytea, bytea),
+	FUNCTION 1 hashlib_hashbytea_murmur3(bytea);
+
+CREATE OPERATOR CLASS int8_wang64_ops FOR TYPE int8 USING hash AS
+	OPERATOR 1 = (int8, int8),
+	FUNCTION 1 hashlib_hashint8_wang64(int8);
+
+-- extended hash functions, needed for hash partitioning, exist only in PostgreSQL 11+
+DO $$
+BEGIN
+	IF current_setting('server_version_num')::int >= 110000 THEN
+		EXECUTE 'ALTER OPERATOR FAMILY text_city64_ops USING hash ADD FUNCTION 2 hashlib_hashtext_city64_extended(text, int8)';
+		EXECUTE 'ALTER OPERATOR FAMILY bytea_murmur3_ops USING hash ADD FUNCTION 2 hashlib_hashbytea_murmur3_extended(bytea, int8)';
+		EXECUTE 'ALTER OPERATOR FAMILY int8_wang64_ops USING hash ADD FUNCTION 2 hashlib_hashint8_wang64_extended(int8, int8)';
+	END IF;
+END
+$$;
+
+-- tablesample method
+
+CREATE OR REPLACE FUNCTION hashlib(internal) RETURNS tsm_handler
+	AS '$libdir/hashlib', 'pg_hashlib_tsm_handler' LANGUAGE C STRICT;
+
+-- combining CRCs of adjacent chunks
+
+CREATE OR REPLACE FUNCTION crc32_combine(int4, int4, int8) RETURNS int4
+	AS '$libdir/hashlib', 'pg_crc32_combine' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION crc32c_combine(int4, int4, int8) RETURNS int4
+	AS '$libdir/hashlib', 'pg_crc32c_combine' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+-- 256-bit output
+
+CREATE OR REPLACE FUNCTION hash256_string(text, text) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash256_string' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION hash256_string(bytea, text) RETURNS bytea
+	AS '$libdir/hashlib', 'pg_hash256_string' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
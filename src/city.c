@@ -428,6 +428,21 @@ void hlib_cityhash64(const void *s, size_t len, uint64_t *io)
 		io[0] = CityHash64(s, len);
 }
 
+/*
+ * Several seeds in one pass: seeded hash is unseeded hash mixed
+ * with seed, so data is hashed once.  out[i] is same as from
+ * hlib_cityhash64() with io[0] = seeds[i].
+ */
+void hlib_cityhash64_multi(const void *s, size_t len, const uint64_t *seeds,
+			   uint64_t *out, int nseeds)
+{
+	uint64_t h = CityHash64(s, len);
+	int i;
+
+	for (i = 0; i < nseeds; i++)
+		out[i] = seeds[i] ? HashLen16(h - k2, seeds[i]) : h;
+}
+
 void hlib_cityhash128(const void *data, size_t len, uint64_t *io)
 {
 	city_uint128 res;
@@ -442,3 +457,192 @@ void hlib_cityhash128(const void *data, size_t len, uint64_t *io)
 	io[1] = res.second;
 }
 
+
+/*
+ * CityHashCrc128 and CityHashCrc256, from upstream city.cc.
+ * They need SSE4.2 crc32 instruction, which is checked at runtime.
+ */
+
+#if defined(__GNUC__) && defined(__x86_64__)
+
+#include <nmmintrin.h>
+
+#define CITY_USE_CRC
+
+// Requires len >= 240.
+__attribute__((target("sse4.2")))
+static void CityHashCrc256Long(const char *s, size_t len, uint32_t seed, uint64_t *result)
+{
+	uint64_t a = Fetch64(s + 56) + k0;
+	uint64_t b = Fetch64(s + 96) + k0;
+	uint64_t c = result[0] = HashLen16(b, len);
+	uint64_t d = result[1] = Fetch64(s + 120) * k0 + len;
+	uint64_t e = Fetch64(s + 184) + seed;
+	uint64_t f = seed;
+	uint64_t g = 0;
+	uint64_t h = 0;
+	uint64_t i = 0;
+	uint64_t j = 0;
+	uint64_t t = c + d;
+	uint64_t old_a;
+
+	// 240 bytes of input per iter.
+	size_t iters = len / 240;
+	len -= iters * 240;
+
+#define CHUNK(multiplier, z) \
+	do { \
+		old_a = a; \
+		a = Rotate(b, 41 ^ z) * multiplier + Fetch64(s); \
+		b = Rotate(c, 27 ^ z) * multiplier + Fetch64(s + 8); \
+		c = Rotate(d, 41 ^ z) * multiplier + Fetch64(s + 16); \
+		d = Rotate(e, 33 ^ z) * multiplier + Fetch64(s + 24); \
+		e = Rotate(t, 25 ^ z) * multiplier + Fetch64(s + 32); \
+		t = old_a; \
+		f = _mm_crc32_u64(f, a); \
+		g = _mm_crc32_u64(g, b); \
+		h = _mm_crc32_u64(h, c); \
+		i = _mm_crc32_u64(i, d); \
+		j = _mm_crc32_u64(j, e); \
+		s += 40; \
+	} while (0)
+
+	do {
+		CHUNK(1, 1); CHUNK(k0, 0);
+		CHUNK(1, 1); CHUNK(k0, 0);
+		CHUNK(1, 1); CHUNK(k0, 0);
+	} while (--iters > 0);
+
+	while (len >= 40) {
+		CHUNK(k0, 0);
+		len -= 40;
+	}
+	if (len > 0) {
+		s = s + len - 40;
+		CHUNK(k0, 0);
+	}
+#undef CHUNK
+
+	j += i << 32;
+	a = HashLen16(a, j);
+	h += g << 32;
+	b += h;
+	c = HashLen16(c, f) + i;
+	d = HashLen16(d, e + result[0]);
+	j += e;
+	i += HashLen16(h, t);
+	e = HashLen16(a, d) + j;
+	f = HashLen16(b, c) + a;
+	g = HashLen16(j, i) + c;
+	result[0] = e + f + g + h;
+	a = ShiftMix((a + g) * k0) * k0 + b;
+	result[1] += a + result[0];
+	a = ShiftMix(a * k0) * k0 + c;
+	result[2] = a + result[1];
+	a = ShiftMix((a + e) * k0) * k0;
+	result[3] = a + result[2];
+}
+
+// Requires len < 240.
+static void CityHashCrc256Short(const char *s, size_t len, uint64_t *result)
+{
+	char buf[240];
+	memcpy(buf, s, len);
+	memset(buf + len, 0, 240 - len);
+	CityHashCrc256Long(buf, 240, ~(uint32_t) len, result);
+}
+
+static void CityHashCrc256(const char *s, size_t len, uint64_t *result)
+{
+	if (LIKELY(len >= 240))
+		CityHashCrc256Long(s, len, 0, result);
+	else
+		CityHashCrc256Short(s, len, result);
+}
+
+static city_uint128 CityHashCrc128WithSeed(const char *s, size_t len, city_uint128 seed)
+{
+	uint64_t result[4];
+	uint64_t u, v;
+	city_uint128 res;
+
+	if (len <= 900)
+		return CityHash128WithSeed(s, len, seed);
+
+	CityHashCrc256(s, len, result);
+	u = Uint128High64(seed) + result[0];
+	v = Uint128Low64(seed) + result[1];
+	res.first = HashLen16(u, v + result[2]);
+	res.second = HashLen16(Rotate(v, 32), u * k0 + result[3]);
+	return res;
+}
+
+static city_uint128 CityHashCrc128(const char *s, size_t len)
+{
+	uint64_t result[4];
+	city_uint128 res;
+
+	if (len <= 900)
+		return CityHash128(s, len);
+
+	CityHashCrc256(s, len, result);
+	res.first = result[2];
+	res.second = result[3];
+	return res;
+}
+
+#endif
+
+/* error out if CPU cannot run crc variants */
+static void citycrc_check(const char *name)
+{
+#ifdef CITY_USE_CRC
+	static int supported = -1;
+
+	if (supported < 0) {
+		__builtin_cpu_init();
+		supported = __builtin_cpu_supports("sse4.2") ? 1 : 0;
+	}
+	if (supported)
+		return;
+#endif
+	elog(ERROR, "hash '%s' requires CPU with SSE4.2 support", name);
+}
+
+void hlib_citycrc128(const void *data, size_t len, uint64_t *io)
+{
+	citycrc_check("citycrc128");
+#ifdef CITY_USE_CRC
+	{
+		city_uint128 res;
+		if (io[0]) {
+			res.first = io[0];
+			res.second = io[1];
+			res = CityHashCrc128WithSeed(data, len, res);
+		} else {
+			res = CityHashCrc128(data, len);
+		}
+		io[0] = res.first;
+		io[1] = res.second;
+	}
+#endif
+}
+
+/* full 256-bit result, out must have room for 4 values */
+void hlib_citycrc256(const void *data, size_t len, uint64_t *out)
+{
+	citycrc_check("citycrc256");
+#ifdef CITY_USE_CRC
+	CityHashCrc256(data, len, out);
+#endif
+}
+
+/* first 128 bits, for callers with MAX_IO_VALUES sized io */
+void hlib_citycrc256_128(const void *data, size_t len, uint64_t *io)
+{
+	uint64_t out[HASH256_VALUES];
+
+	hlib_citycrc256(data, len, out);
+	io[0] = out[0];
+	io[1] = out[1];
+}
@@ -82,12 +82,256 @@ static const uint32_t crc32tab[256] = {
 	0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d,
 };
 
-void hlib_crc32(const void *data, size_t size, uint64_t *io)
+/*
+ * Slicing-by-8: tables for 1..7 extra zero bytes, 8 bytes per step.
+ * Generated from crc32tab on first use.
+ */
+static uint32_t crc32tab8[8][256];
+
+static void crc32_init_tables(void)
+{
+	uint32_t crc;
+	int i, k;
+
+	for (i = 0; i < 256; i++) {
+		crc = crc32tab[i];
+		crc32tab8[0][i] = crc;
+		for (k = 1; k < 8; k++) {
+			crc = (crc >> 8) ^ crc32tab[crc & 0xff];
+			crc32tab8[k][i] = crc;
+		}
+	}
+}
+
+static inline uint32_t crc32_le32dec(const uint8_t *p)
+{
+	uint32_t v;
+	memcpy(&v, p, 4);
+	return le32toh(v);
+}
+
+static uint32_t crc32_update_slice8(uint32_t crc, const void *data, size_t size)
 {
 	const uint8_t *ptr = data;
-	uint32_t crc = ~(uint32_t)io[0];
+	uint32_t w1, w2;
+
+	/* align for word reads */
+	for (; size > 0 && ((uintptr_t)ptr & 7); size--, ptr++)
+		crc = _CRC32_(crc, *ptr);
+
+	for (; size >= 8; size -= 8, ptr += 8) {
+		w1 = crc32_le32dec(ptr) ^ crc;
+		w2 = crc32_le32dec(ptr + 4);
+		crc = crc32tab8[7][w1 & 0xff] ^ crc32tab8[6][(w1 >> 8) & 0xff]
+			^ crc32tab8[5][(w1 >> 16) & 0xff] ^ crc32tab8[4][w1 >> 24]
+			^ crc32tab8[3][w2 & 0xff] ^ crc32tab8[2][(w2 >> 8) & 0xff]
+			^ crc32tab8[1][(w2 >> 16) & 0xff] ^ crc32tab8[0][w2 >> 24];
+	}
+
 	for (; size--; ptr++)
 		crc = _CRC32_(crc, *ptr);
-	io[0] = ~crc;
+	return crc;
 }
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+
+#include <immintrin.h>
+
+#define CRC32_USE_PCLMUL
+#define CRC32_TARGET_PCLMUL __attribute__((target("pclmul,sse2")))
+
+/* at least this many bytes for folding */
+#define CRC32_PCLMUL_MIN	64
+
+/*
+ * Folding with carry-less multiply, 4x128 bits per step.
+ *
+ * Constants are x^(N+32) mod P and x^(N-32) mod P for folding distance
+ * N, bit-reflected and shifted left by one, with N = 512 for 4-way loop
+ * and N = 128 for single register.  Folding keeps value of data mod P,
+ * so last 16 bytes of folded register are finished with table code.
+ */
+CRC32_TARGET_PCLMUL
+static uint32_t crc32_update_pclmul(uint32_t crc, const void *data, size_t size)
+{
+	const uint8_t *ptr = data;
+	const __m128i k1k2 = _mm_set_epi64x(UINT64_C(0x1c6e41596), UINT64_C(0x154442bd4));
+	const __m128i k3k4 = _mm_set_epi64x(UINT64_C(0x0ccaa009e), UINT64_C(0x1751997d0));
+	__m128i x0, x1, x2, x3, t0, t1, t2, t3;
+	uint8_t buf[16];
+
+	if (size < CRC32_PCLMUL_MIN)
+		return crc32_update_slice8(crc, data, size);
+
+	x0 = _mm_xor_si128(_mm_loadu_si128((const __m128i *)ptr), _mm_cvtsi32_si128((int)crc));
+	x1 = _mm_loadu_si128((const __m128i *)(ptr + 16));
+	x2 = _mm_loadu_si128((const __m128i *)(ptr + 32));
+	x3 = _mm_loadu_si128((const __m128i *)(ptr + 48));
+	ptr += 64;
+	size -= 64;
+
+	for (; size >= 64; size -= 64, ptr += 64) {
+		t0 = _mm_clmulepi64_si128(x0, k1k2, 0x00);
+		t1 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+		t2 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+		t3 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+		x0 = _mm_xor_si128(_mm_clmulepi64_si128(x0, k1k2, 0x11), t0);
+		x1 = _mm_xor_si128(_mm_clmulepi64_si128(x1, k1k2, 0x11), t1);
+		x2 = _mm_xor_si128(_mm_clmulepi64_si128(x2, k1k2, 0x11), t2);
+		x3 = _mm_xor_si128(_mm_clmulepi64_si128(x3, k1k2, 0x11), t3);
+		x0 = _mm_xor_si128(x0, _mm_loadu_si128((const __m128i *)ptr));
+		x1 = _mm_xor_si128(x1, _mm_loadu_si128((const __m128i *)(ptr + 16)));
+		x2 = _mm_xor_si128(x2, _mm_loadu_si128((const __m128i *)(ptr + 32)));
+		x3 = _mm_xor_si128(x3, _mm_loadu_si128((const __m128i *)(ptr + 48)));
+	}
+
+	/* fold 4 registers into one */
+	t0 = _mm_clmulepi64_si128(x0, k3k4, 0x00);
+	x0 = _mm_xor_si128(_mm_clmulepi64_si128(x0, k3k4, 0x11), t0);
+	x0 = _mm_xor_si128(x0, x1);
+	t0 = _mm_clmulepi64_si128(x0, k3k4, 0x00);
+	x0 = _mm_xor_si128(_mm_clmulepi64_si128(x0, k3k4, 0x11), t0);
+	x0 = _mm_xor_si128(x0, x2);
+	t0 = _mm_clmulepi64_si128(x0, k3k4, 0x00);
+	x0 = _mm_xor_si128(_mm_clmulepi64_si128(x0, k3k4, 0x11), t0);
+	x0 = _mm_xor_si128(x0, x3);
+
+	for (; size >= 16; size -= 16, ptr += 16) {
+		t0 = _mm_clmulepi64_si128(x0, k3k4, 0x00);
+		x0 = _mm_xor_si128(_mm_clmulepi64_si128(x0, k3k4, 0x11), t0);
+		x0 = _mm_xor_si128(x0, _mm_loadu_si128((const __m128i *)ptr));
+	}
+
+	_mm_storeu_si128((__m128i *)buf, x0);
+	crc = crc32_update_slice8(0, buf, 16);
+	return crc32_update_slice8(crc, ptr, size);
+}
+
+#endif
+
+typedef uint32_t (*crc32_update_fn)(uint32_t crc, const void *data, size_t size);
+
+/* pick implementation for this CPU, once */
+static crc32_update_fn crc32_get_impl(void)
+{
+	static crc32_update_fn impl;
+
+	if (impl == NULL) {
+		crc32_init_tables();
+		impl = crc32_update_slice8;
+#ifdef CRC32_USE_PCLMUL
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("pclmul"))
+			impl = crc32_update_pclmul;
+#endif
+	}
+	return impl;
+}
+
+static uint32_t crc32_update(uint32_t crc, const void *data, size_t size)
+{
+	return crc32_get_impl()(crc, data, size);
+}
+
+void hlib_crc32(const void *data, size_t size, uint64_t *io)
+{
+	io[0] = ~crc32_update(~(uint32_t)io[0], data, size);
+}
+
+/*
+ * Combining CRCs of adjacent chunks.
+ *
+ * crc2 is shifted over len2 zero bytes by applying GF(2) matrix of
+ * one zero bit squared up to needed powers, as in zlib crc32_combine().
+ * Works for any reflected CRC-32 with pre and post inversion.
+ */
+
+static inline uint32_t gf2_matrix_times(const uint32_t *mat, uint32_t vec)
+{
+	uint32_t sum = 0;
+
+	for (; vec; vec >>= 1, mat++) {
+		if (vec & 1)
+			sum ^= *mat;
+	}
+	return sum;
+}
+
+static void gf2_matrix_square(uint32_t *square, const uint32_t *mat)
+{
+	int n;
+
+	for (n = 0; n < 32; n++)
+		square[n] = gf2_matrix_times(mat, mat[n]);
+}
+
+uint32_t hlib_crc_combine(uint32_t poly, uint32_t crc1, uint32_t crc2, uint64_t len2)
+{
+	uint32_t even[32];
+	uint32_t odd[32];
+	uint32_t row = 1;
+	int n;
+
+	if (len2 == 0)
+		return crc1;
+
+	/* operator for one zero bit */
+	odd[0] = poly;
+	for (n = 1; n < 32; n++) {
+		odd[n] = row;
+		row <<= 1;
+	}
+
+	/* two and four zero bits */
+	gf2_matrix_square(even, odd);
+	gf2_matrix_square(odd, even);
+
+	/* first square gives one zero byte, apply operators for bits of len2 */
+	do {
+		gf2_matrix_square(even, odd);
+		if (len2 & 1)
+			crc1 = gf2_matrix_times(even, crc1);
+		len2 >>= 1;
+		if (len2 == 0)
+			break;
+
+		gf2_matrix_square(odd, even);
+		if (len2 & 1)
+			crc1 = gf2_matrix_times(odd, crc1);
+		len2 >>= 1;
+	} while (len2);
+
+	return crc1 ^ crc2;
+}
+
+uint32_t hlib_crc32_combine(uint32_t crc1, uint32_t crc2, uint64_t len2)
+{
+	return hlib_crc_combine(0xedb88320, crc1, crc2, len2);
+}
+
+/*
+ * Incremental API, state is running crc.
+ */
+
+static void crc32_stream_init(void *state, const uint64_t *io)
+{
+	*(uint32_t *)state = ~(uint32_t)io[0];
+}
+
+static void crc32_stream_update(void *state, const void *data, size_t size)
+{
+	*(uint32_t *)state = crc32_update(*(uint32_t *)state, data, size);
+}
+
+static void crc32_stream_final(void *state, uint64_t *io)
+{
+	io[0] = ~*(uint32_t *)state;
+}
+
+const struct HashStreamOps hlib_crc32_stream = {
+	sizeof(uint32_t),
+	crc32_stream_init,
+	crc32_stream_update,
+	crc32_stream_final,
+};
+
@@ -0,0 +1,269 @@
+
+/* CRC32C (Castagnoli) checksum */
+
+#include "pghashlib.h"
+
+/*
+ * Reflected Castagnoli polynomial:
+ *	x^32 + x^28 + x^27 + x^26 + x^25 + x^23 + x^22 + x^20 +
+ *	x^19 + x^18 + x^14 + x^13 + x^11 + x^10 + x^9 + x^8 + x^6 + 1
+ *
+ * Hardware versions run three independent CRCs over adjacent
+ * blocks to hide instruction latency, then shift first CRCs over
+ * following blocks with zero-operator tables and combine them,
+ * same as in Mark Adler's crc32c.c.  Tables are built with
+ * hlib_crc_combine().
+ */
+#define CRC32C_POLY	0x82f63b78
+
+#define CRC32C_LONG	8192
+#define CRC32C_SHORT	256
+
+/* slicing-by-8 tables */
+static uint32_t crc32c_table[8][256];
+
+/* tables for shifting crc over CRC32C_LONG and CRC32C_SHORT zero bytes */
+static uint32_t crc32c_long[4][256];
+static uint32_t crc32c_short[4][256];
+
+#define _CRC32C_(crc, ch)	(((crc) >> 8) ^ crc32c_table[0][((crc) ^ (ch)) & 0xff])
+
+/* multiply crc by GF(2) matrix */
+static inline uint32_t crc32c_apply(const uint32_t *op, uint32_t crc)
+{
+	uint32_t sum = 0;
+
+	for (; crc; crc >>= 1, op++) {
+		if (crc & 1)
+			sum ^= *op;
+	}
+	return sum;
+}
+
+static void crc32c_zeros(uint32_t zeros[][256], size_t len)
+{
+	uint32_t op[32];
+	uint32_t n;
+	int i;
+
+	/* operator matrix, columns are shifted single bits */
+	for (i = 0; i < 32; i++)
+		op[i] = hlib_crc_combine(CRC32C_POLY, (uint32_t)1 << i, 0, len);
+
+	for (n = 0; n < 256; n++) {
+		zeros[0][n] = crc32c_apply(op, n);
+		zeros[1][n] = crc32c_apply(op, n << 8);
+		zeros[2][n] = crc32c_apply(op, n << 16);
+		zeros[3][n] = crc32c_apply(op, n << 24);
+	}
+}
+
+static inline uint32_t crc32c_shift(uint32_t zeros[][256], uint32_t crc)
+{
+	return zeros[0][crc & 0xff] ^ zeros[1][(crc >> 8) & 0xff]
+		^ zeros[2][(crc >> 16) & 0xff] ^ zeros[3][crc >> 24];
+}
+
+static void crc32c_init_tables(void)
+{
+	uint32_t crc;
+	int i, k;
+
+	for (i = 0; i < 256; i++) {
+		crc = i;
+		for (k = 0; k < 8; k++)
+			crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+		crc32c_table[0][i] = crc;
+	}
+	for (i = 0; i < 256; i++) {
+		crc = crc32c_table[0][i];
+		for (k = 1; k < 8; k++) {
+			crc = (crc >> 8) ^ crc32c_table[0][crc & 0xff];
+			crc32c_table[k][i] = crc;
+		}
+	}
+
+	crc32c_zeros(crc32c_long, CRC32C_LONG);
+	crc32c_zeros(crc32c_short, CRC32C_SHORT);
+}
+
+static inline uint32_t crc32c_le32dec(const uint8_t *p)
+{
+	uint32_t v;
+	memcpy(&v, p, 4);
+	return le32toh(v);
+}
+
+static uint32_t crc32c_update_slice8(uint32_t crc, const void *data, size_t size)
+{
+	const uint8_t *ptr = data;
+	uint32_t w1, w2;
+
+	for (; size > 0 && ((uintptr_t)ptr & 7); size--, ptr++)
+		crc = _CRC32C_(crc, *ptr);
+
+	for (; size >= 8; size -= 8, ptr += 8) {
+		w1 = crc32c_le32dec(ptr) ^ crc;
+		w2 = crc32c_le32dec(ptr + 4);
+		crc = crc32c_table[7][w1 & 0xff] ^ crc32c_table[6][(w1 >> 8) & 0xff]
+			^ crc32c_table[5][(w1 >> 16) & 0xff] ^ crc32c_table[4][w1 >> 24]
+			^ crc32c_table[3][w2 & 0xff] ^ crc32c_table[2][(w2 >> 8) & 0xff]
+			^ crc32c_table[1][(w2 >> 16) & 0xff] ^ crc32c_table[0][w2 >> 24];
+	}
+
+	for (; size--; ptr++)
+		crc = _CRC32C_(crc, *ptr);
+	return crc;
+}
+
+/*
+ * Three-way interleaved loop, instantiated for each instruction set.
+ * CRC_U8 and CRC_U64 give crc instruction for one and eight bytes.
+ */
+#define CRC32C_HW_BODY(CRC_U8, CRC_U64) \
+	const uint8_t *ptr = data; \
+	const uint8_t *end; \
+	uint64_t crc0 = crc, crc1, crc2; \
+	\
+	for (; size > 0 && ((uintptr_t)ptr & 7); size--, ptr++) \
+		crc0 = CRC_U8((uint32_t)crc0, *ptr); \
+	\
+	while (size >= 3 * CRC32C_LONG) { \
+		crc1 = crc2 = 0; \
+		end = ptr + CRC32C_LONG; \
+		do { \
+			crc0 = CRC_U64(crc0, *(const uint64_t *)ptr); \
+			crc1 = CRC_U64(crc1, *(const uint64_t *)(ptr + CRC32C_LONG)); \
+			crc2 = CRC_U64(crc2, *(const uint64_t *)(ptr + 2 * CRC32C_LONG)); \
+			ptr += 8; \
+		} while (ptr < end); \
+		crc0 = crc32c_shift(crc32c_long, crc0) ^ crc1; \
+		crc0 = crc32c_shift(crc32c_long, crc0) ^ crc2; \
+		ptr += 2 * CRC32C_LONG; \
+		size -= 3 * CRC32C_LONG; \
+	} \
+	\
+	while (size >= 3 * CRC32C_SHORT) { \
+		crc1 = crc2 = 0; \
+		end = ptr + CRC32C_SHORT; \
+		do { \
+			crc0 = CRC_U64(crc0, *(const uint64_t *)ptr); \
+			crc1 = CRC_U64(crc1, *(const uint64_t *)(ptr + CRC32C_SHORT)); \
+			crc2 = CRC_U64(crc2, *(const uint64_t *)(ptr + 2 * CRC32C_SHORT)); \
+			ptr += 8; \
+		} while (ptr < end); \
+		crc0 = crc32c_shift(crc32c_short, crc0) ^ crc1; \
+		crc0 = crc32c_shift(crc32c_short, crc0) ^ crc2; \
+		ptr += 2 * CRC32C_SHORT; \
+		size -= 3 * CRC32C_SHORT; \
+	} \
+	\
+	for (; size >= 8; size -= 8, ptr += 8) \
+		crc0 = CRC_U64(crc0, *(const uint64_t *)ptr); \
+	for (; size > 0; size--, ptr++) \
+		crc0 = CRC_U8((uint32_t)crc0, *ptr); \
+	return (uint32_t)crc0;
+
+#if defined(__GNUC__) && defined(__x86_64__)
+
+#include <nmmintrin.h>
+
+#define CRC32C_USE_SSE42
+
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_update_sse42(uint32_t crc, const void *data, size_t size)
+{
+	CRC32C_HW_BODY(_mm_crc32_u8, _mm_crc32_u64)
+}
+
+#elif defined(__GNUC__) && defined(__aarch64__) \
+	&& (defined(__ARM_FEATURE_CRC32) || defined(__linux__))
+
+#include <arm_acle.h>
+
+#define CRC32C_USE_ARMV8
+
+/* without -march=...+crc, check HWCAP at runtime */
+#ifndef __ARM_FEATURE_CRC32
+#include <sys/auxv.h>
+#ifndef HWCAP_CRC32
+#define HWCAP_CRC32 (1 << 7)
+#endif
+#endif
+
+#ifdef __clang__
+__attribute__((target("crc")))
+#else
+__attribute__((target("+crc")))
+#endif
+static uint32_t crc32c_update_armv8(uint32_t crc, const void *data, size_t size)
+{
+	CRC32C_HW_BODY(__crc32cb, __crc32cd)
+}
+
+#endif
+
+typedef uint32_t (*crc32c_update_fn)(uint32_t crc, const void *data, size_t size);
+
+/* pick implementation for this CPU, once */
+static crc32c_update_fn crc32c_get_impl(void)
+{
+	static crc32c_update_fn impl;
+
+	if (impl == NULL) {
+		crc32c_init_tables();
+		impl = crc32c_update_slice8;
+#if defined(CRC32C_USE_SSE42)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("sse4.2"))
+			impl = crc32c_update_sse42;
+#elif defined(CRC32C_USE_ARMV8) && defined(__ARM_FEATURE_CRC32)
+		impl = crc32c_update_armv8;
+#elif defined(CRC32C_USE_ARMV8)
+		if (getauxval(AT_HWCAP) & HWCAP_CRC32)
+			impl = crc32c_update_armv8;
+#endif
+	}
+	return impl;
+}
+
+static uint32_t crc32c_update(uint32_t crc, const void *data, size_t size)
+{
+	return crc32c_get_impl()(crc, data, size);
+}
+
+void hlib_crc32c(const void *data, size_t size, uint64_t *io)
+{
+	io[0] = ~crc32c_update(~(uint32_t)io[0], data, size);
+}
+
+uint32_t hlib_crc32c_combine(uint32_t crc1, uint32_t crc2, uint64_t len2)
+{
+	return hlib_crc_combine(CRC32C_POLY, crc1, crc2, len2);
+}
+
+/*
+ * Incremental API, state is running crc.
+ */
+
+static void crc32c_stream_init(void *state, const uint64_t *io)
+{
+	*(uint32_t *)state = ~(uint32_t)io[0];
+}
+
+static void crc32c_stream_update(void *state, const void *data, size_t size)
+{
+	*(uint32_t *)state = crc32c_update(*(uint32_t *)state, data, size);
+}
+
+static void crc32c_stream_final(void *state, uint64_t *io)
+{
+	io[0] = ~*(uint32_t *)state;
+}
+
+const struct HashStreamOps hlib_crc32c_stream = {
+	sizeof(uint32_t),
+	crc32c_stream_init,
+	crc32c_stream_update,
+	crc32c_stream_final,
+};
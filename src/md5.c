@@ -227,3 +227,41 @@ void hlib_md5(const void *data, size_t len, uint64_t *io)
 	md5_final(&ctx, io);
 }
 
+
+/*
+ * Incremental API.
+ */
+
+static void md5_stream_init(void *state, const uint64_t *io)
+{
+	struct md5_ctx *ctx = state;
+	md5_reset(ctx);
+	if (io[0])
+		md5_update(ctx, io, 16);
+}
+
+static void md5_stream_update(void *state, const void *data, size_t len)
+{
+	const uint8_t *ptr = data;
+	unsigned int n;
+
+	/* md5_update() takes only unsigned int */
+	while (len > 0) {
+		n = (len > (1U << 30)) ? (1U << 30) : len;
+		md5_update(state, ptr, n);
+		ptr += n;
+		len -= n;
+	}
+}
+
+static void md5_stream_final(void *state, uint64_t *io)
+{
+	md5_final(state, io);
+}
+
+const struct HashStreamOps hlib_md5_stream = {
+	sizeof(struct md5_ctx),
+	md5_stream_init,
+	md5_stream_update,
+	md5_stream_final,
+};
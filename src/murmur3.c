@@ -88,3 +88,357 @@ void hlib_murmur3(const void *key, size_t len, uint64_t *io)
 	 io[0] = h1;
 }
 
+
+//-----------------------------------------------------------------------------
+// Incremental API, unfinished block is kept in tail.
+
+struct murmur3_stream {
+	 uint32_t h1;
+	 uint32_t len;
+	 uint8_t tail[4];
+};
+
+static inline uint32_t murmur3_mix(uint32_t h1, uint32_t k1)
+{
+	 k1 *= 0xcc9e2d51;
+	 k1 = ROTL32(k1, 15);
+	 k1 *= 0x1b873593;
+	 h1 ^= k1;
+	 h1 = ROTL32(h1, 13);
+	 return h1 * 5 + 0xe6546b64;
+}
+
+static void murmur3_stream_init(void *state, const uint64_t *io)
+{
+	 struct murmur3_stream *st = state;
+	 st->h1 = io[0];
+	 st->len = 0;
+}
+
+static void murmur3_stream_update(void *state, const void *key, size_t len)
+{
+	 struct murmur3_stream *st = state;
+	 const uint8_t *data = key;
+	 unsigned pos = st->len & 3;
+	 uint32_t h1 = st->h1;
+	 uint32_t k1;
+
+	 st->len += len;
+
+	 if (pos > 0) {
+		  while (pos < 4 && len > 0) {
+			   st->tail[pos++] = *data++;
+			   len--;
+		  }
+		  if (pos < 4)
+			   return;
+		  memcpy(&k1, st->tail, 4);
+		  h1 = murmur3_mix(h1, k1);
+	 }
+
+	 for (; len >= 4; data += 4, len -= 4) {
+		  memcpy(&k1, data, 4);
+		  h1 = murmur3_mix(h1, k1);
+	 }
+	 memcpy(st->tail, data, len);
+	 st->h1 = h1;
+}
+
+static void murmur3_stream_final(void *state, uint64_t *io)
+{
+	 struct murmur3_stream *st = state;
+	 const uint8_t *tail = st->tail;
+	 uint32_t h1 = st->h1;
+	 uint32_t k1 = 0;
+
+	 switch (st->len & 3) {
+	 case 3:
+		  k1 ^= tail[2] << 16;
+		  // fall through
+	 case 2:
+		  k1 ^= tail[1] << 8;
+		  // fall through
+	 case 1:
+		  k1 ^= tail[0];
+		  k1 *= 0xcc9e2d51;
+		  k1 = ROTL32(k1, 15);
+		  k1 *= 0x1b873593;
+		  h1 ^= k1;
+	 };
+
+	 h1 ^= st->len;
+	 io[0] = fmix(h1);
+}
+
+const struct HashStreamOps hlib_murmur3_stream = {
+	 sizeof(struct murmur3_stream),
+	 murmur3_stream_init,
+	 murmur3_stream_update,
+	 murmur3_stream_final,
+};
+
+//-----------------------------------------------------------------------------
+// Several seeds in one pass.  Block mixing does not depend on seed,
+// so it is done once per block for group of seeds.  out[i] is same
+// as from hlib_murmur3() with io[0] = seeds[i].
+
+#define MULTI_GROUP 64
+
+void hlib_murmur3_multi(const void *key, size_t len, const uint64_t *seeds,
+			uint64_t *out, int nseeds)
+{
+	 const uint8_t *data = (const uint8_t *) key;
+	 const uint8_t *tail = data + (len & ~(size_t)3);
+	 uint32_t h[MULTI_GROUP];
+	 uint32_t k1;
+	 size_t pos;
+	 int base, n, i;
+
+	 for (base = 0; base < nseeds; base += MULTI_GROUP) {
+		  n = nseeds - base;
+		  if (n > MULTI_GROUP)
+			   n = MULTI_GROUP;
+		  for (i = 0; i < n; i++)
+			   h[i] = seeds[base + i];
+
+		  // body
+		  for (pos = 0; pos + 4 <= len; pos += 4) {
+			   memcpy(&k1, data + pos, 4);
+			   k1 *= 0xcc9e2d51;
+			   k1 = ROTL32(k1, 15);
+			   k1 *= 0x1b873593;
+			   for (i = 0; i < n; i++) {
+				    h[i] ^= k1;
+				    h[i] = ROTL32(h[i], 13);
+				    h[i] = h[i] * 5 + 0xe6546b64;
+			   }
+		  }
+
+		  // tail
+		  k1 = 0;
+		  switch (len & 3) {
+		  case 3:
+			   k1 ^= tail[2] << 16;
+			   // fall through
+		  case 2:
+			   k1 ^= tail[1] << 8;
+			   // fall through
+		  case 1:
+			   k1 ^= tail[0];
+			   k1 *= 0xcc9e2d51;
+			   k1 = ROTL32(k1, 15);
+			   k1 *= 0x1b873593;
+		  };
+
+		  // finalization
+		  for (i = 0; i < n; i++)
+			   out[base + i] = fmix((h[i] ^ k1) ^ (uint32_t) len);
+	 }
+}
+
+//-----------------------------------------------------------------------------
+// 128-bit variants.  Blocks are read as little-endian from any alignment,
+// so results match other MurmurHash3 implementations on all CPUs.
+
+static inline uint64_t rotl64(uint64_t x, int8_t r)
+{
+	 return (x << r) | (x >> (64 - r));
+}
+
+#define	ROTL64(x,y)	rotl64(x,y)
+
+static inline uint32_t getblock32_le(const uint8_t *p)
+{
+	 uint32_t v;
+	 memcpy(&v, p, 4);
+	 return le32toh(v);
+}
+
+static inline uint64_t getblock64_le(const uint8_t *p)
+{
+	 uint64_t v;
+	 memcpy(&v, p, 8);
+	 return le64toh(v);
+}
+
+static inline uint64_t fmix64(uint64_t k)
+{
+	 k ^= k >> 33;
+	 k *= UINT64_C(0xff51afd7ed558ccd);
+	 k ^= k >> 33;
+	 k *= UINT64_C(0xc4ceb9fe1a85ec53);
+	 k ^= k >> 33;
+	 return k;
+}
+
+//-----------------------------------------------------------------------------
+// MurmurHash3_x64_128.  Seed is h1 = io[0], h2 = io[1], reference
+// 32-bit seed s is io[0] = io[1] = s.  Result is h1 in io[0], h2 in io[1].
+
+void hlib_murmur3_128(const void *key, size_t len, uint64_t *io)
+{
+	 const uint8_t *data = (const uint8_t *) key;
+	 const size_t nblocks = len / 16;
+	 const uint8_t *tail;
+	 uint64_t h1 = io[0];
+	 uint64_t h2 = io[1];
+	 const uint64_t c1 = UINT64_C(0x87c37b91114253d5);
+	 const uint64_t c2 = UINT64_C(0x4cf5ad432745937f);
+	 uint64_t k1, k2;
+	 size_t i;
+
+	 //----------
+	 // body
+	 for (i = 0; i < nblocks; i++) {
+		  k1 = getblock64_le(data + i * 16);
+		  k2 = getblock64_le(data + i * 16 + 8);
+
+		  k1 *= c1; k1 = ROTL64(k1, 31); k1 *= c2; h1 ^= k1;
+		  h1 = ROTL64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+
+		  k2 *= c2; k2 = ROTL64(k2, 33); k2 *= c1; h2 ^= k2;
+		  h2 = ROTL64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+	 }
+
+	 //----------
+	 // tail
+	 tail = data + nblocks * 16;
+	 k1 = 0;
+	 k2 = 0;
+	 switch (len & 15) {
+	 case 15: k2 ^= (uint64_t)tail[14] << 48;	// fall through
+	 case 14: k2 ^= (uint64_t)tail[13] << 40;	// fall through
+	 case 13: k2 ^= (uint64_t)tail[12] << 32;	// fall through
+	 case 12: k2 ^= (uint64_t)tail[11] << 24;	// fall through
+	 case 11: k2 ^= (uint64_t)tail[10] << 16;	// fall through
+	 case 10: k2 ^= (uint64_t)tail[9] << 8;	// fall through
+	 case 9:
+		  k2 ^= (uint64_t)tail[8];
+		  k2 *= c2; k2 = ROTL64(k2, 33); k2 *= c1; h2 ^= k2;
+		  // fall through
+	 case 8: k1 ^= (uint64_t)tail[7] << 56;	// fall through
+	 case 7: k1 ^= (uint64_t)tail[6] << 48;	// fall through
+	 case 6: k1 ^= (uint64_t)tail[5] << 40;	// fall through
+	 case 5: k1 ^= (uint64_t)tail[4] << 32;	// fall through
+	 case 4: k1 ^= (uint64_t)tail[3] << 24;	// fall through
+	 case 3: k1 ^= (uint64_t)tail[2] << 16;	// fall through
+	 case 2: k1 ^= (uint64_t)tail[1] << 8;	// fall through
+	 case 1:
+		  k1 ^= (uint64_t)tail[0];
+		  k1 *= c1; k1 = ROTL64(k1, 31); k1 *= c2; h1 ^= k1;
+	 };
+
+	 //----------
+	 // finalization
+	 h1 ^= len;
+	 h2 ^= len;
+
+	 h1 += h2;
+	 h2 += h1;
+
+	 h1 = fmix64(h1);
+	 h2 = fmix64(h2);
+
+	 h1 += h2;
+	 h2 += h1;
+
+	 io[0] = h1;
+	 io[1] = h2;
+}
+
+//-----------------------------------------------------------------------------
+// MurmurHash3_x86_128.  Seed is h1..h4 = low and high halves of io[0]
+// and io[1], reference 32-bit seed s is io[0] = io[1] = s | s << 32.
+// Result is h1, h2 in io[0] and h3, h4 in io[1], low half first.
+
+void hlib_murmur3_x86_128(const void *key, size_t len, uint64_t *io)
+{
+	 const uint8_t *data = (const uint8_t *) key;
+	 const size_t nblocks = len / 16;
+	 const uint8_t *tail;
+	 uint32_t h1 = (uint32_t) io[0];
+	 uint32_t h2 = (uint32_t) (io[0] >> 32);
+	 uint32_t h3 = (uint32_t) io[1];
+	 uint32_t h4 = (uint32_t) (io[1] >> 32);
+	 const uint32_t c1 = 0x239b961b;
+	 const uint32_t c2 = 0xab0e9789;
+	 const uint32_t c3 = 0x38b34ae5;
+	 const uint32_t c4 = 0xa1e38b93;
+	 uint32_t k1, k2, k3, k4;
+	 size_t i;
+
+	 //----------
+	 // body
+	 for (i = 0; i < nblocks; i++) {
+		  k1 = getblock32_le(data + i * 16);
+		  k2 = getblock32_le(data + i * 16 + 4);
+		  k3 = getblock32_le(data + i * 16 + 8);
+		  k4 = getblock32_le(data + i * 16 + 12);
+
+		  k1 *= c1; k1 = ROTL32(k1, 15); k1 *= c2; h1 ^= k1;
+		  h1 = ROTL32(h1, 19); h1 += h2; h1 = h1 * 5 + 0x561ccd1b;
+
+		  k2 *= c2; k2 = ROTL32(k2, 16); k2 *= c3; h2 ^= k2;
+		  h2 = ROTL32(h2, 17); h2 += h3; h2 = h2 * 5 + 0x0bcaa747;
+
+		  k3 *= c3; k3 = ROTL32(k3, 17); k3 *= c4; h3 ^= k3;
+		  h3 = ROTL32(h3, 15); h3 += h4; h3 = h3 * 5 + 0x96cd1c35;
+
+		  k4 *= c4; k4 = ROTL32(k4, 18); k4 *= c1; h4 ^= k4;
+		  h4 = ROTL32(h4, 13); h4 += h1; h4 = h4 * 5 + 0x32ac3b17;
+	 }
+
+	 //----------
+	 // tail
+	 tail = data + nblocks * 16;
+	 k1 = 0;
+	 k2 = 0;
+	 k3 = 0;
+	 k4 = 0;
+	 switch (len & 15) {
+	 case 15: k4 ^= tail[14] << 16;	// fall through
+	 case 14: k4 ^= tail[13] << 8;	// fall through
+	 case 13:
+		  k4 ^= tail[12] << 0;
+		  k4 *= c4; k4 = ROTL32(k4, 18); k4 *= c1; h4 ^= k4;
+		  // fall through
+	 case 12: k3 ^= (uint32_t)tail[11] << 24;	// fall through
+	 case 11: k3 ^= tail[10] << 16;	// fall through
+	 case 10: k3 ^= tail[9] << 8;	// fall through
+	 case 9:
+		  k3 ^= tail[8] << 0;
+		  k3 *= c3; k3 = ROTL32(k3, 17); k3 *= c4; h3 ^= k3;
+		  // fall through
+	 case 8: k2 ^= (uint32_t)tail[7] << 24;	// fall through
+	 case 7: k2 ^= tail[6] << 16;	// fall through
+	 case 6: k2 ^= tail[5] << 8;	// fall through
+	 case 5:
+		  k2 ^= tail[4] << 0;
+		  k2 *= c2; k2 = ROTL32(k2, 16); k2 *= c3; h2 ^= k2;
+		  // fall through
+	 case 4: k1 ^= (uint32_t)tail[3] << 24;	// fall through
+	 case 3: k1 ^= tail[2] << 16;	// fall through
+	 case 2: k1 ^= tail[1] << 8;	// fall through
+	 case 1:
+		  k1 ^= tail[0] << 0;
+		  k1 *= c1; k1 = ROTL32(k1, 15); k1 *= c2; h1 ^= k1;
+	 };
+
+	 //----------
+	 // finalization
+	 h1 ^= len; h2 ^= len; h3 ^= len; h4 ^= len;
+
+	 h1 += h2; h1 += h3; h1 += h4;
+	 h2 += h1; h3 += h1; h4 += h1;
+
+	 h1 = fmix(h1);
+	 h2 = fmix(h2);
+	 h3 = fmix(h3);
+	 h4 = fmix(h4);
+
+	 h1 += h2; h1 += h3; h1 += h4;
+	 h2 += h1; h3 += h1; h4 += h1;
+
+	 io[0] = h1 | ((uint64_t) h2 << 32);
+	 io[1] = h3 | ((uint64_t) h4 << 32);
+}
@@ -0,0 +1,326 @@
+/*
+ * Aggregates over string hashes.
+ */
+
+#include "pghashlib.h"
+
+#if PG_VERSION_NUM >= 90600
+
+#include "catalog/pg_type.h"
+#include "libpq/pqformat.h"
+#include "utils/builtins.h"
+
+PG_FUNCTION_INFO_V1(pg_fingerprint_transfn);
+PG_FUNCTION_INFO_V1(pg_fingerprint_combine);
+PG_FUNCTION_INFO_V1(pg_fingerprint_serial);
+PG_FUNCTION_INFO_V1(pg_fingerprint_deserial);
+PG_FUNCTION_INFO_V1(pg_fingerprint_final);
+PG_FUNCTION_INFO_V1(pg_hash_agg_transfn);
+PG_FUNCTION_INFO_V1(pg_hash_agg_final32);
+PG_FUNCTION_INFO_V1(pg_hash_agg_final64);
+PG_FUNCTION_INFO_V1(pg_hash_agg_final128);
+
+/*
+ * Utility functions.
+ */
+
+static void
+send_hash_name(StringInfo buf, const struct StrHashDesc *desc)
+{
+	pq_sendbyte(buf, desc->namelen);
+	pq_sendbytes(buf, desc->name, desc->namelen);
+}
+
+static const struct StrHashDesc *
+recv_hash_name(StringInfo buf)
+{
+	const struct StrHashDesc *desc;
+	int nlen;
+
+	nlen = pq_getmsgbyte(buf);
+	desc = hlib_find_string_hash(pq_getmsgbytes(buf, nlen), nlen);
+	if (desc == NULL)
+		elog(ERROR, "invalid aggregate state: unknown hash");
+	return desc;
+}
+
+/*
+ * Order-independent fingerprint.
+ *
+ * Sum of 128-bit row hashes, modulo 2^128.  Row hash is same
+ * as hash128_string(data, algo) gives.
+ */
+
+struct FingerprintState {
+	const struct StrHashDesc *desc;
+	uint64_t sum[2];
+};
+
+static void
+fingerprint_add(struct FingerprintState *st, const uint64_t *val)
+{
+	st->sum[0] += val[0];
+	st->sum[1] += val[1] + (st->sum[0] < val[0]);
+}
+
+/* hashlib_fingerprint_transfn(internal, bytea, text) returns internal */
+Datum
+pg_fingerprint_transfn(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggctx = hlib_agg_context(fcinfo, "hashlib_fingerprint_transfn");
+	struct FingerprintState *st;
+	const struct StrHashDesc *desc;
+	uint64_t io[MAX_IO_VALUES];
+
+	st = PG_ARGISNULL(0) ? NULL : (struct FingerprintState *) PG_GETARG_POINTER(0);
+	if (PG_ARGISNULL(1) || PG_ARGISNULL(2)) {
+		/* no state until first non-NULL value */
+		if (st == NULL)
+			PG_RETURN_NULL();
+		PG_RETURN_POINTER(st);
+	}
+
+	desc = hlib_load_string_hash(fcinfo, PG_GETARG_TEXT_PP(2));
+	if (st == NULL) {
+		/* 32-bit row hashes would give weak fingerprint */
+		if (desc->bits < 64)
+			elog(ERROR, "fingerprint needs at least 64-bit hash, '%.*s' gives %d bits",
+			     desc->namelen, desc->name, desc->bits);
+		st = MemoryContextAllocZero(aggctx, sizeof(*st));
+		st->desc = desc;
+	} else if (st->desc != desc) {
+		elog(ERROR, "hash algorithm must not change inside aggregate");
+	}
+
+	memset(io, 0, sizeof(io));
+	hlib_hash_varlena(desc->hash, desc->stream, PG_GETARG_DATUM(1), io);
+	fingerprint_add(st, io);
+
+	PG_RETURN_POINTER(st);
+}
+
+/* hashlib_fingerprint_combine(internal, internal) returns internal */
+Datum
+pg_fingerprint_combine(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggctx = hlib_agg_context(fcinfo, "hashlib_fingerprint_combine");
+	struct FingerprintState *st1, *st2;
+
+	st1 = PG_ARGISNULL(0) ? NULL : (struct FingerprintState *) PG_GETARG_POINTER(0);
+	st2 = PG_ARGISNULL(1) ? NULL : (struct FingerprintState *) PG_GETARG_POINTER(1);
+
+	if (st2 == NULL) {
+		if (st1 == NULL)
+			PG_RETURN_NULL();
+		PG_RETURN_POINTER(st1);
+	}
+	if (st1 == NULL) {
+		st1 = MemoryContextAlloc(aggctx, sizeof(*st1));
+		memcpy(st1, st2, sizeof(*st1));
+		PG_RETURN_POINTER(st1);
+	}
+	if (st1->desc != st2->desc)
+		elog(ERROR, "hash algorithm must not change inside aggregate");
+
+	fingerprint_add(st1, st2->sum);
+	PG_RETURN_POINTER(st1);
+}
+
+/* hashlib_fingerprint_serial(internal) returns bytea */
+Datum
+pg_fingerprint_serial(PG_FUNCTION_ARGS)
+{
+	struct FingerprintState *st = (struct FingerprintState *) PG_GETARG_POINTER(0);
+	StringInfoData buf;
+
+	pq_begintypsend(&buf);
+	send_hash_name(&buf, st->desc);
+	pq_sendint64(&buf, st->sum[0]);
+	pq_sendint64(&buf, st->sum[1]);
+	PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+/* hashlib_fingerprint_deserial(bytea, internal) returns internal */
+Datum
+pg_fingerprint_deserial(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggctx = hlib_agg_context(fcinfo, "hashlib_fingerprint_deserial");
+	bytea *data = PG_GETARG_BYTEA_PP(0);
+	struct FingerprintState *st;
+	StringInfoData buf;
+
+	buf.data = VARDATA_ANY(data);
+	buf.len = VARSIZE_ANY_EXHDR(data);
+	buf.maxlen = buf.len;
+	buf.cursor = 0;
+
+	st = MemoryContextAlloc(aggctx, sizeof(*st));
+	st->desc = recv_hash_name(&buf);
+	st->sum[0] = pq_getmsgint64(&buf);
+	st->sum[1] = pq_getmsgint64(&buf);
+	pq_getmsgend(&buf);
+
+	PG_RETURN_POINTER(st);
+}
+
+/* hashlib_fingerprint_final(internal) returns bytea */
+Datum
+pg_fingerprint_final(PG_FUNCTION_ARGS)
+{
+	struct FingerprintState *st;
+	uint64_t sum[2] = { 0, 0 };
+	bytea *res;
+
+	st = PG_ARGISNULL(0) ? NULL : (struct FingerprintState *) PG_GETARG_POINTER(0);
+	if (st) {
+		sum[0] = st->sum[0];
+		sum[1] = st->sum[1];
+	}
+
+	/* always output little-endian */
+	sum[0] = htole64(sum[0]);
+	sum[1] = htole64(sum[1]);
+
+	res = palloc(VARHDRSZ + 16);
+	SET_VARSIZE(res, VARHDRSZ + 16);
+	memcpy(VARDATA(res), sum, 16);
+	PG_RETURN_BYTEA_P(res);
+}
+
+/*
+ * Order-dependent streaming hash.
+ *
+ * Values are fed into incremental hash as they arrive, result is same
+ * as hashing concatenation of all values, without building it.
+ */
+
+struct StreamAggState {
+	const struct StrHashDesc *desc;
+	uint64_t iv[MAX_IO_VALUES];
+	uint64_t state[FLEXIBLE_ARRAY_MEMBER];
+};
+
+/* hash_string_agg_transfn(internal, bytea, text [, int4|int8]) returns internal */
+Datum
+pg_hash_agg_transfn(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggctx = hlib_agg_context(fcinfo, "hash_string_agg_transfn");
+	struct StreamAggState *st;
+	struct varlena *data;
+
+	st = PG_ARGISNULL(0) ? NULL : (struct StreamAggState *) PG_GETARG_POINTER(0);
+	if (PG_ARGISNULL(1)) {
+		/* no state until first non-NULL value */
+		if (st == NULL)
+			PG_RETURN_NULL();
+		PG_RETURN_POINTER(st);
+	}
+
+	if (st == NULL) {
+		const struct StrHashDesc *desc;
+		text *hashname;
+
+		if (PG_ARGISNULL(2))
+			elog(ERROR, "hash algorithm must not be NULL");
+		hashname = PG_GETARG_TEXT_PP(2);
+		desc = hlib_load_string_hash(fcinfo, hashname);
+		if (desc->stream == NULL)
+			elog(ERROR, "hash '%s' does not support incremental hashing",
+			     text_to_cstring(hashname));
+
+		st = MemoryContextAllocZero(aggctx, offsetof(struct StreamAggState, state)
+					    + desc->stream->state_size);
+		st->desc = desc;
+
+		/* decide initval */
+		if (PG_NARGS() >= 4 && !PG_ARGISNULL(3)) {
+			if (get_fn_expr_argtype(fcinfo->flinfo, 3) == INT4OID)
+				st->iv[0] = PG_GETARG_INT32(3);
+			else
+				st->iv[0] = PG_GETARG_INT64(3);
+		} else {
+			st->iv[0] = desc->initval;
+		}
+
+		desc->stream->init(st->state, st->iv);
+	}
+
+	/* big toasted values are fed in pieces */
+	if (hlib_stream_toasted(st->desc->stream, st->state, PG_GETARG_DATUM(1)))
+		PG_RETURN_POINTER(st);
+
+	/* request aligned data on weird architectures */
+#ifdef HLIB_UNALIGNED_READ_OK
+	data = PG_GETARG_VARLENA_PP(1);
+#else
+	data = PG_GETARG_VARLENA_P(1);
+#endif
+
+	st->desc->stream->update(st->state, VARDATA_ANY(data), VARSIZE_ANY_EXHDR(data));
+
+	PG_FREE_IF_COPY(data, 1);
+
+	PG_RETURN_POINTER(st);
+}
+
+/* finish hash on copy of state, as final function may be called repeatedly */
+static void
+hash_agg_finish(struct StreamAggState *st, uint64_t *io)
+{
+	const struct HashStreamOps *ops = st->desc->stream;
+	void *tmp;
+
+	tmp = palloc(ops->state_size);
+	memcpy(tmp, st->state, ops->state_size);
+	io[0] = st->iv[0];
+	io[1] = st->iv[1];
+	ops->final(tmp, io);
+	pfree(tmp);
+}
+
+/* hash_string_agg_final(internal) returns int4 */
+Datum
+pg_hash_agg_final32(PG_FUNCTION_ARGS)
+{
+	uint64_t io[MAX_IO_VALUES];
+
+	if (PG_ARGISNULL(0))
+		PG_RETURN_NULL();
+	hash_agg_finish((struct StreamAggState *) PG_GETARG_POINTER(0), io);
+	PG_RETURN_INT32(io[0]);
+}
+
+/* hash64_string_agg_final(internal) returns int8 */
+Datum
+pg_hash_agg_final64(PG_FUNCTION_ARGS)
+{
+	uint64_t io[MAX_IO_VALUES];
+
+	if (PG_ARGISNULL(0))
+		PG_RETURN_NULL();
+	hash_agg_finish((struct StreamAggState *) PG_GETARG_POINTER(0), io);
+	PG_RETURN_INT64(io[0]);
+}
+
+/* hash128_string_agg_final(internal) returns bytea */
+Datum
+pg_hash_agg_final128(PG_FUNCTION_ARGS)
+{
+	uint64_t io[MAX_IO_VALUES];
+	bytea *res;
+
+	if (PG_ARGISNULL(0))
+		PG_RETURN_NULL();
+	hash_agg_finish((struct StreamAggState *) PG_GETARG_POINTER(0), io);
+
+	/* always output little-endian */
+	io[0] = htole64(io[0]);
+	io[1] = htole64(io[1]);
+
+	res = palloc(VARHDRSZ + 16);
+	SET_VARSIZE(res, VARHDRSZ + 16);
+	memcpy(VARDATA(res), io, 16);
+	PG_RETURN_BYTEA_P(res);
+}
+
+#endif
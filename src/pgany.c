@@ -0,0 +1,456 @@
+/*
+ * Hashing of values of any type.
+ *
+ * Value is turned into stable byte string and hashed with string hash:
+ *
+ * - pass-by-value types and 8-byte types like int8 and float8:
+ *   value bytes in little-endian; for float4 and float8 -0 is
+ *   turned into 0 and all NaNs into one NaN, same as float equality
+ * - text, varchar, bytea, name: stored bytes
+ * - bpchar: stored bytes without trailing spaces, same as bpchar equality
+ * - arrays: ndim, dims and lower bounds as int4, then per element
+ *   null flag byte and element encoding
+ * - records: number of columns as int4, then per column
+ *   null flag byte and column encoding
+ * - others: output of binary send function, run with client encoding
+ *   same as server encoding, so text inside does not depend on session
+ *
+ * Integers are in little-endian.  Inside arrays and records variable-length
+ * encodings are prefixed with int4 length.  Top-level text and bytea give
+ * same result as hash_string().
+ */
+
+#include "pghashlib.h"
+
+#if PG_VERSION_NUM >= 90600
+
+#include <math.h>
+
+#include "access/htup_details.h"
+#include "catalog/pg_type.h"
+#include "lib/stringinfo.h"
+#include "mb/pg_wchar.h"
+#include "miscadmin.h"
+#include "utils/array.h"
+#include "utils/builtins.h"
+#include "utils/lsyscache.h"
+#include "utils/typcache.h"
+
+#ifndef TupleDescAttr
+#define TupleDescAttr(tupdesc, i) ((tupdesc)->attrs[(i)])
+#endif
+
+PG_FUNCTION_INFO_V1(pg_hash_any);
+PG_FUNCTION_INFO_V1(pg_hash64_any);
+PG_FUNCTION_INFO_V1(pg_hash128_any);
+
+enum AnyKind {
+	ANY_BYVAL,
+	ANY_INT64,
+	ANY_RAW,
+	ANY_BPCHAR,
+	ANY_FLOAT4,
+	ANY_FLOAT8,
+	ANY_NAME,
+	ANY_SEND,
+	ANY_ARRAY,
+	ANY_RECORD,
+};
+
+struct AnyType {
+	struct AnyType *next;
+	Oid typid;
+	enum AnyKind kind;
+	int16 typlen;
+	bool typbyval;
+	char typalign;
+	Oid elemtype;
+	FmgrInfo send;
+};
+
+/* per-call-site cache in fn_extra */
+struct AnyCache {
+	const struct StrHashDesc *desc;
+	unsigned namelen;
+	char name[HASHNAMELEN];
+	MemoryContext mcxt;
+	struct AnyType *types;
+};
+
+static void encode_value(struct AnyCache *cache, StringInfo buf, Oid typid, Datum value, bool top);
+
+static struct AnyCache *
+load_cache(FunctionCallInfo fcinfo, text *hashname)
+{
+	struct AnyCache *cache = fcinfo->flinfo->fn_extra;
+	const char *name = VARDATA_ANY(hashname);
+	unsigned nlen = VARSIZE_ANY_EXHDR(hashname);
+
+	if (cache == NULL) {
+		cache = MemoryContextAllocZero(fcinfo->flinfo->fn_mcxt, sizeof(*cache));
+		cache->mcxt = fcinfo->flinfo->fn_mcxt;
+		fcinfo->flinfo->fn_extra = cache;
+	}
+
+	if (cache->desc == NULL || cache->namelen != nlen || memcmp(cache->name, name, nlen) != 0) {
+		cache->desc = hlib_find_string_hash(name, nlen);
+		if (cache->desc == NULL)
+			elog(ERROR, "hash '%s' not found", text_to_cstring(hashname));
+		cache->namelen = nlen;
+		memcpy(cache->name, name, nlen);
+	}
+	return cache;
+}
+
+/* find out how to encode type, result is cached */
+static struct AnyType *
+load_type(struct AnyCache *cache, Oid typid)
+{
+	struct AnyType *t;
+	Oid basetype;
+	Oid sendfn;
+	bool isvarlena;
+
+	for (t = cache->types; t; t = t->next) {
+		if (t->typid == typid)
+			return t;
+	}
+
+	t = MemoryContextAllocZero(cache->mcxt, sizeof(*t));
+	t->typid = typid;
+
+	basetype = getBaseType(typid);
+	get_typlenbyvalalign(basetype, &t->typlen, &t->typbyval, &t->typalign);
+
+	if (basetype == RECORDOID || type_is_rowtype(basetype)) {
+		t->kind = ANY_RECORD;
+	} else if ((t->elemtype = get_element_type(basetype)) != InvalidOid) {
+		t->kind = ANY_ARRAY;
+	} else if (basetype == FLOAT4OID) {
+		t->kind = ANY_FLOAT4;
+	} else if (basetype == FLOAT8OID) {
+		/* by-value or not, depending on build */
+		t->kind = ANY_FLOAT8;
+	} else if (t->typbyval) {
+		t->kind = ANY_BYVAL;
+	} else if (t->typlen == 8 && t->typalign == 'd') {
+		/* int8, float8, timestamp on builds where they are not by-value */
+		t->kind = ANY_INT64;
+	} else if (basetype == TEXTOID || basetype == VARCHAROID || basetype == BYTEAOID) {
+		t->kind = ANY_RAW;
+	} else if (basetype == BPCHAROID) {
+		t->kind = ANY_BPCHAR;
+	} else if (basetype == NAMEOID) {
+		t->kind = ANY_NAME;
+	} else {
+		t->kind = ANY_SEND;
+		getTypeBinaryOutputInfo(basetype, &sendfn, &isvarlena);
+		fmgr_info_cxt(sendfn, &t->send, cache->mcxt);
+	}
+
+	t->next = cache->types;
+	cache->types = t;
+	return t;
+}
+
+/*
+ * Encoding helpers.
+ */
+
+/*
+ * Send functions of text-like types (json, jsonb, xml, enum, citext,
+ * ranges over text) convert to client encoding with pq_sendtext().
+ * Switch client encoding to server one around the call, so result
+ * is immutable.
+ */
+static bytea *
+send_server_encoding(FmgrInfo *send, Datum value)
+{
+	int client_enc = pg_get_client_encoding();
+	int server_enc = GetDatabaseEncoding();
+	bytea *res;
+
+	if (client_enc == server_enc)
+		return SendFunctionCall(send, value);
+
+	SetClientEncoding(server_enc);
+	PG_TRY();
+	{
+		res = SendFunctionCall(send, value);
+	}
+	PG_CATCH();
+	{
+		SetClientEncoding(client_enc);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	if (SetClientEncoding(client_enc) < 0)
+		elog(ERROR, "could not restore client encoding");
+	return res;
+}
+
+static void
+put_le(StringInfo buf, uint64_t val, int len)
+{
+	unsigned char tmp[8];
+	int i;
+
+	for (i = 0; i < len; i++) {
+		tmp[i] = val & 0xFF;
+		val >>= 8;
+	}
+	appendBinaryStringInfo(buf, (char *) tmp, len);
+}
+
+static void
+put_bytes(StringInfo buf, const char *data, int len, bool top)
+{
+	if (!top)
+		put_le(buf, len, 4);
+	appendBinaryStringInfo(buf, data, len);
+}
+
+static uint64_t
+byval_value(Datum value, int typlen)
+{
+	switch (typlen) {
+	case 1:
+		return (uint8) DatumGetChar(value);
+	case 2:
+		return (uint16) DatumGetInt16(value);
+	case 4:
+		return (uint32) DatumGetInt32(value);
+	case 8:
+		return (uint64) DatumGetInt64(value);
+	default:
+		elog(ERROR, "unsupported by-value type length: %d", typlen);
+	}
+	return 0;
+}
+
+/* float bits with -0 and NaN payloads folded, like float4eq() */
+static uint32_t
+float4_bits(float4 val)
+{
+	union { float4 f; uint32_t u; } x;
+
+	if (isnan(val))
+		return 0x7FC00000;
+	x.f = (val == 0) ? 0.0f : val;
+	return x.u;
+}
+
+static uint64_t
+float8_bits(float8 val)
+{
+	union { float8 f; uint64_t u; } x;
+
+	if (isnan(val))
+		return UINT64_C(0x7FF8000000000000);
+	x.f = (val == 0) ? 0.0 : val;
+	return x.u;
+}
+
+/* length without trailing spaces, like bpchartruelen() */
+static int
+bpchar_len(const char *data, int len)
+{
+	while (len > 0 && data[len - 1] == ' ')
+		len--;
+	return len;
+}
+
+static void
+encode_array(struct AnyCache *cache, StringInfo buf, struct AnyType *t, Datum value)
+{
+	ArrayType *arr = DatumGetArrayTypeP(value);
+	struct AnyType *et = load_type(cache, t->elemtype);
+	int ndim = ARR_NDIM(arr);
+	Datum *elems;
+	bool *nulls;
+	int nelems;
+	int i;
+
+	put_le(buf, ndim, 4);
+	for (i = 0; i < ndim; i++) {
+		put_le(buf, ARR_DIMS(arr)[i], 4);
+		put_le(buf, ARR_LBOUND(arr)[i], 4);
+	}
+
+	deconstruct_array(arr, t->elemtype, et->typlen, et->typbyval, et->typalign,
+			  &elems, &nulls, &nelems);
+	for (i = 0; i < nelems; i++) {
+		appendStringInfoChar(buf, nulls[i] ? 1 : 0);
+		if (!nulls[i])
+			encode_value(cache, buf, t->elemtype, elems[i], false);
+	}
+	pfree(elems);
+	pfree(nulls);
+}
+
+static void
+encode_record(struct AnyCache *cache, StringInfo buf, Datum value)
+{
+	HeapTupleHeader rec = DatumGetHeapTupleHeader(value);
+	HeapTupleData tuple;
+	TupleDesc tupdesc;
+	Datum *values;
+	bool *nulls;
+	int natts = 0;
+	int i;
+
+	tupdesc = lookup_rowtype_tupdesc(HeapTupleHeaderGetTypeId(rec),
+					 HeapTupleHeaderGetTypMod(rec));
+
+	tuple.t_len = HeapTupleHeaderGetDatumLength(rec);
+	ItemPointerSetInvalid(&tuple.t_self);
+	tuple.t_tableOid = InvalidOid;
+	tuple.t_data = rec;
+
+	values = palloc(tupdesc->natts * sizeof(Datum));
+	nulls = palloc(tupdesc->natts * sizeof(bool));
+	heap_deform_tuple(&tuple, tupdesc, values, nulls);
+
+	for (i = 0; i < tupdesc->natts; i++) {
+		if (!TupleDescAttr(tupdesc, i)->attisdropped)
+			natts++;
+	}
+	put_le(buf, natts, 4);
+
+	for (i = 0; i < tupdesc->natts; i++) {
+		Form_pg_attribute att = TupleDescAttr(tupdesc, i);
+
+		if (att->attisdropped)
+			continue;
+		appendStringInfoChar(buf, nulls[i] ? 1 : 0);
+		if (!nulls[i])
+			encode_value(cache, buf, att->atttypid, values[i], false);
+	}
+
+	ReleaseTupleDesc(tupdesc);
+	pfree(values);
+	pfree(nulls);
+}
+
+static void
+encode_value(struct AnyCache *cache, StringInfo buf, Oid typid, Datum value, bool top)
+{
+	struct AnyType *t = load_type(cache, typid);
+	struct varlena *data;
+	bytea *res;
+
+	check_stack_depth();
+
+	switch (t->kind) {
+	case ANY_BYVAL:
+		put_le(buf, byval_value(value, t->typlen), t->typlen);
+		break;
+	case ANY_INT64:
+		put_le(buf, *(uint64 *) DatumGetPointer(value), 8);
+		break;
+	case ANY_RAW:
+		data = PG_DETOAST_DATUM_PACKED(value);
+		put_bytes(buf, VARDATA_ANY(data), VARSIZE_ANY_EXHDR(data), top);
+		if ((Pointer) data != DatumGetPointer(value))
+			pfree(data);
+		break;
+	case ANY_BPCHAR:
+		data = PG_DETOAST_DATUM_PACKED(value);
+		put_bytes(buf, VARDATA_ANY(data), bpchar_len(VARDATA_ANY(data), VARSIZE_ANY_EXHDR(data)), top);
+		if ((Pointer) data != DatumGetPointer(value))
+			pfree(data);
+		break;
+	case ANY_FLOAT4:
+		put_le(buf, float4_bits(DatumGetFloat4(value)), 4);
+		break;
+	case ANY_FLOAT8:
+		put_le(buf, float8_bits(DatumGetFloat8(value)), 8);
+		break;
+	case ANY_NAME:
+		put_bytes(buf, NameStr(*DatumGetName(value)), strlen(NameStr(*DatumGetName(value))), top);
+		break;
+	case ANY_SEND:
+		res = send_server_encoding(&t->send, value);
+		put_bytes(buf, VARDATA(res), VARSIZE(res) - VARHDRSZ, top);
+		pfree(res);
+		break;
+	case ANY_ARRAY:
+		encode_array(cache, buf, t, value);
+		break;
+	case ANY_RECORD:
+		encode_record(cache, buf, value);
+		break;
+	}
+}
+
+static void
+hash_any_value(FunctionCallInfo fcinfo, int bits, uint64_t *io)
+{
+	struct AnyCache *cache = load_cache(fcinfo, PG_GETARG_TEXT_PP(1));
+	const struct StrHashDesc *desc = cache->desc;
+	Oid typid = get_fn_expr_argtype(fcinfo->flinfo, 0);
+	struct AnyType *t;
+	StringInfoData buf;
+
+	if (typid == InvalidOid)
+		elog(ERROR, "could not determine input data type");
+
+	/* same initvals as string functions without seeds */
+	memset(io, 0, sizeof(uint64_t) * MAX_IO_VALUES);
+	if (bits < 128)
+		io[0] = desc->initval;
+
+	/* plain strings can be hashed directly */
+	t = load_type(cache, typid);
+	if (t->kind == ANY_RAW) {
+		hlib_hash_varlena(desc->hash, desc->stream, PG_GETARG_DATUM(0), io);
+		return;
+	}
+
+	initStringInfo(&buf);
+	encode_value(cache, &buf, typid, PG_GETARG_DATUM(0), true);
+	desc->hash(buf.data, buf.len, io);
+	pfree(buf.data);
+}
+
+/* hash_any(anyelement, text) returns int4 */
+Datum
+pg_hash_any(PG_FUNCTION_ARGS)
+{
+	uint64_t io[MAX_IO_VALUES];
+
+	hash_any_value(fcinfo, 32, io);
+	PG_RETURN_INT32(io[0]);
+}
+
+/* hash64_any(anyelement, text) returns int8 */
+Datum
+pg_hash64_any(PG_FUNCTION_ARGS)
+{
+	uint64_t io[MAX_IO_VALUES];
+
+	hash_any_value(fcinfo, 64, io);
+	PG_RETURN_INT64(io[0]);
+}
+
+/* hash128_any(anyelement, text) returns bytea */
+Datum
+pg_hash128_any(PG_FUNCTION_ARGS)
+{
+	uint64_t io[MAX_IO_VALUES];
+	bytea *res;
+
+	hash_any_value(fcinfo, 128, io);
+
+	/* always output little-endian */
+	io[0] = htole64(io[0]);
+	io[1] = htole64(io[1]);
+
+	res = palloc(VARHDRSZ + 16);
+	SET_VARSIZE(res, VARHDRSZ + 16);
+	memcpy(VARDATA(res), io, 16);
+	PG_RETURN_BYTEA_P(res);
+}
+
+#endif
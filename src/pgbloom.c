@@ -0,0 +1,293 @@
+/*
+ * Bloom filter type.
+ *
+ * Probe positions come from single 128-bit hash of value, same as
+ * hash128_string(value, algo) gives, using double hashing:
+ *
+ *   pos[i] = (h1 + i * h2) mod 2^64 mod nbits
+ *
+ * where h1 and h2 are first and second little-endian 64-bit words
+ * of the hash.
+ *
+ * Binary format (send/recv, text I/O is same in hex):
+ *
+ *   byte 0       version, 1
+ *   byte 1       number of hashes
+ *   bytes 2-3    reserved, 0
+ *   bytes 4-7    number of bits, uint32 little-endian
+ *   bytes 8-23   algorithm name, zero-padded
+ *   bytes 24-    bits, bit i is (byte[i / 8] >> (i % 8)) & 1
+ */
+
+#include "pghashlib.h"
+
+#if PG_VERSION_NUM >= 90600
+
+#include <math.h>
+
+#include "libpq/pqformat.h"
+#include "utils/builtins.h"
+
+#define BLOOM_VERSION		1
+#define BLOOM_ALGO_LEN		16
+#define BLOOM_MAX_HASHES	32
+#define BLOOM_MAX_BITS		((uint64_t)1 << 32)
+
+struct BloomFilter {
+	int32 vl_len_;
+	uint8 version;
+	uint8 nhashes;
+	uint16 reserved;
+	uint32 nbits_le;
+	char algo[BLOOM_ALGO_LEN];
+	uint8 bits[FLEXIBLE_ARRAY_MEMBER];
+};
+
+#define BLOOM_HDRSZ		offsetof(struct BloomFilter, bits)
+#define BLOOM_NBITS(bf)		le32toh((bf)->nbits_le)
+#define BLOOM_SIZE(nbits)	(BLOOM_HDRSZ + (nbits) / 8)
+
+#define PG_GETARG_BLOOM_P(n)	((struct BloomFilter *) PG_DETOAST_DATUM(PG_GETARG_DATUM(n)))
+
+PG_FUNCTION_INFO_V1(pg_bloom_in);
+PG_FUNCTION_INFO_V1(pg_bloom_out);
+PG_FUNCTION_INFO_V1(pg_bloom_recv);
+PG_FUNCTION_INFO_V1(pg_bloom_send);
+PG_FUNCTION_INFO_V1(pg_bloom_agg_transfn);
+PG_FUNCTION_INFO_V1(pg_bloom_union);
+PG_FUNCTION_INFO_V1(pg_bloom_contains);
+
+static const struct StrHashDesc *
+bloom_hash(const char *name, unsigned nlen)
+{
+	const struct StrHashDesc *desc;
+
+	desc = hlib_find_string_hash(name, nlen);
+	if (desc == NULL)
+		elog(ERROR, "hash '%.*s' not found", nlen, name);
+	if (desc->bits < 128)
+		elog(ERROR, "bloom filter needs 128-bit hash, '%.*s' gives %d bits",
+		     nlen, name, desc->bits);
+	return desc;
+}
+
+static const struct StrHashDesc *
+bloom_filter_hash(const struct BloomFilter *bf)
+{
+	return bloom_hash(bf->algo, strnlen(bf->algo, BLOOM_ALGO_LEN));
+}
+
+/* validate external data */
+static void
+bloom_check(const struct BloomFilter *bf)
+{
+	uint32 nbits;
+
+	if (VARSIZE(bf) < BLOOM_HDRSZ)
+		elog(ERROR, "invalid bloom filter: too short");
+	nbits = BLOOM_NBITS(bf);
+	if (bf->version != BLOOM_VERSION)
+		elog(ERROR, "invalid bloom filter: unsupported version %d", bf->version);
+	if (bf->nhashes < 1 || bf->nhashes > BLOOM_MAX_HASHES)
+		elog(ERROR, "invalid bloom filter: bad number of hashes");
+	if (nbits == 0 || nbits % 8 != 0 || VARSIZE(bf) != BLOOM_SIZE(nbits))
+		elog(ERROR, "invalid bloom filter: bad size");
+	bloom_filter_hash(bf);
+}
+
+static struct BloomFilter *
+bloom_create(int64 expected_n, double fp_rate, text *hashname)
+{
+	const struct StrHashDesc *desc;
+	struct BloomFilter *bf;
+	double nbits, k;
+	uint32 nbytes;
+
+	desc = bloom_hash(VARDATA_ANY(hashname), VARSIZE_ANY_EXHDR(hashname));
+	if (expected_n < 1)
+		elog(ERROR, "expected number of values must be positive");
+	if (!(fp_rate > 0 && fp_rate < 1))
+		elog(ERROR, "false positive rate must be between 0 and 1");
+
+	/* optimal size and number of hashes */
+	nbits = ceil(-(double) expected_n * log(fp_rate) / (M_LN2 * M_LN2));
+	if (nbits > BLOOM_MAX_BITS - 8)
+		elog(ERROR, "bloom filter too large");
+	nbytes = ((uint32) nbits + 7) / 8;
+	k = rint(nbytes * 8.0 / expected_n * M_LN2);
+	k = Max(1, Min(BLOOM_MAX_HASHES, k));
+
+	bf = palloc0(BLOOM_SIZE(nbytes * 8));
+	SET_VARSIZE(bf, BLOOM_SIZE(nbytes * 8));
+	bf->version = BLOOM_VERSION;
+	bf->nhashes = (uint8) k;
+	bf->nbits_le = htole32(nbytes * 8);
+	memcpy(bf->algo, desc->name, desc->namelen);
+	return bf;
+}
+
+/* get 128-bit hash of value, same as hash128_string() */
+static void
+bloom_hash_value(const struct StrHashDesc *desc, Datum value, uint64_t *io)
+{
+	memset(io, 0, sizeof(uint64_t) * MAX_IO_VALUES);
+	hlib_hash_varlena(desc->hash, desc->stream, value, io);
+}
+
+static void
+bloom_add(struct BloomFilter *bf, const uint64_t *io)
+{
+	uint64_t nbits = BLOOM_NBITS(bf);
+	uint64_t h = io[0];
+	uint64_t pos;
+	int i;
+
+	for (i = 0; i < bf->nhashes; i++) {
+		pos = h % nbits;
+		bf->bits[pos / 8] |= 1 << (pos % 8);
+		h += io[1];
+	}
+}
+
+static bool
+bloom_test(const struct BloomFilter *bf, const uint64_t *io)
+{
+	uint64_t nbits = BLOOM_NBITS(bf);
+	uint64_t h = io[0];
+	uint64_t pos;
+	int i;
+
+	for (i = 0; i < bf->nhashes; i++) {
+		pos = h % nbits;
+		if (!(bf->bits[pos / 8] & (1 << (pos % 8))))
+			return false;
+		h += io[1];
+	}
+	return true;
+}
+
+/*
+ * Type I/O.
+ */
+
+/* hashlib_bloom_in(cstring) returns hashlib_bloom */
+Datum
+pg_bloom_in(PG_FUNCTION_ARGS)
+{
+	const char *str = PG_GETARG_CSTRING(0);
+	struct BloomFilter *bf;
+
+	bf = (struct BloomFilter *) hlib_hex_in(str, "bloom filter");
+	bloom_check(bf);
+	PG_RETURN_POINTER(bf);
+}
+
+/* hashlib_bloom_out(hashlib_bloom) returns cstring */
+Datum
+pg_bloom_out(PG_FUNCTION_ARGS)
+{
+	struct BloomFilter *bf = PG_GETARG_BLOOM_P(0);
+
+	PG_RETURN_CSTRING(hlib_hex_out((char *) bf + VARHDRSZ, VARSIZE(bf) - VARHDRSZ));
+}
+
+/* hashlib_bloom_recv(internal) returns hashlib_bloom */
+Datum
+pg_bloom_recv(PG_FUNCTION_ARGS)
+{
+	StringInfo buf = (StringInfo) PG_GETARG_POINTER(0);
+	int len = buf->len - buf->cursor;
+	struct BloomFilter *bf;
+
+	bf = palloc(VARHDRSZ + len);
+	SET_VARSIZE(bf, VARHDRSZ + len);
+	pq_copymsgbytes(buf, (char *) bf + VARHDRSZ, len);
+	bloom_check(bf);
+	PG_RETURN_POINTER(bf);
+}
+
+/* hashlib_bloom_send(hashlib_bloom) returns bytea */
+Datum
+pg_bloom_send(PG_FUNCTION_ARGS)
+{
+	struct BloomFilter *bf = PG_GETARG_BLOOM_P(0);
+	StringInfoData buf;
+
+	pq_begintypsend(&buf);
+	pq_sendbytes(&buf, (char *) bf + VARHDRSZ, VARSIZE(bf) - VARHDRSZ);
+	PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+/*
+ * Aggregate and operations.
+ */
+
+/* bloom_agg_transfn(hashlib_bloom, bytea, int8, float8 [, text]) returns hashlib_bloom */
+Datum
+pg_bloom_agg_transfn(PG_FUNCTION_ARGS)
+{
+	struct BloomFilter *bf;
+	uint64_t io[MAX_IO_VALUES];
+
+	if (!AggCheckCallContext(fcinfo, NULL))
+		elog(ERROR, "bloom_agg_transfn called in non-aggregate context");
+
+	if (PG_ARGISNULL(0)) {
+		text *hashname;
+
+		if (PG_ARGISNULL(2) || PG_ARGISNULL(3) || (PG_NARGS() >= 5 && PG_ARGISNULL(4)))
+			elog(ERROR, "bloom filter parameters must not be NULL");
+		hashname = (PG_NARGS() >= 5) ? PG_GETARG_TEXT_PP(4) : cstring_to_text("city128");
+
+		/* allocated in per-call context, executor copies it to aggregate context */
+		bf = bloom_create(PG_GETARG_INT64(2), PG_GETARG_FLOAT8(3), hashname);
+	} else {
+		/* state is in aggregate context, can be modified in place */
+		bf = PG_GETARG_BLOOM_P(0);
+	}
+
+	if (!PG_ARGISNULL(1)) {
+		bloom_hash_value(bloom_filter_hash(bf), PG_GETARG_DATUM(1), io);
+		bloom_add(bf, io);
+	}
+
+	PG_RETURN_POINTER(bf);
+}
+
+/* bloom_union(hashlib_bloom, hashlib_bloom) returns hashlib_bloom */
+Datum
+pg_bloom_union(PG_FUNCTION_ARGS)
+{
+	struct BloomFilter *bf1, *bf2;
+	uint32 i, nbytes;
+
+	/* aggregate state can be modified in place */
+	if (AggCheckCallContext(fcinfo, NULL))
+		bf1 = PG_GETARG_BLOOM_P(0);
+	else
+		bf1 = (struct BloomFilter *) PG_DETOAST_DATUM_COPY(PG_GETARG_DATUM(0));
+	bf2 = PG_GETARG_BLOOM_P(1);
+
+	if (BLOOM_NBITS(bf1) != BLOOM_NBITS(bf2) || bf1->nhashes != bf2->nhashes
+	    || memcmp(bf1->algo, bf2->algo, BLOOM_ALGO_LEN) != 0)
+		elog(ERROR, "cannot combine bloom filters with different parameters");
+
+	nbytes = BLOOM_NBITS(bf1) / 8;
+	for (i = 0; i < nbytes; i++)
+		bf1->bits[i] |= bf2->bits[i];
+
+	PG_RETURN_POINTER(bf1);
+}
+
+/* bloom_contains(hashlib_bloom, bytea) returns bool */
+Datum
+pg_bloom_contains(PG_FUNCTION_ARGS)
+{
+	struct BloomFilter *bf = PG_GETARG_BLOOM_P(0);
+	uint64_t io[MAX_IO_VALUES];
+
+	bloom_hash_value(bloom_filter_hash(bf), PG_GETARG_DATUM(1), io);
+	PG_RETURN_BOOL(bloom_test(bf, io));
+}
+
+#endif
@@ -0,0 +1,741 @@
+/*
+ * Count-Min sketch.
+ *
+ * Value is hashed once with hash128_string(value, algo), counter
+ * index in row i is:
+ *
+ *   idx[i] = (h1 + i * h2) mod 2^64 mod width
+ *
+ * where h1 and h2 are first and second little-endian 64-bit words
+ * of the hash.  Estimate is minimum over rows, it is never less
+ * than real count.
+ *
+ * Optionally sketch keeps list of values with biggest estimates
+ * seen so far, that is updated as values are added.  In memory the
+ * list is min-heap on estimate, with hash index from value to heap
+ * slot, so update is O(log ntop).
+ *
+ * Binary format (send/recv, text I/O is same in hex):
+ *
+ *   byte 0       version, 1
+ *   byte 1       flags, 1 - values are text
+ *   bytes 2-3    depth, uint16 little-endian
+ *   bytes 4-7    width, uint32 little-endian
+ *   bytes 8-11   max number of heavy hitters, uint32 little-endian
+ *   bytes 12-15  number of heavy hitters, uint32 little-endian
+ *   bytes 16-31  algorithm name, zero-padded
+ *   bytes 32-    counters as uint64 little-endian, row by row,
+ *                then heavy hitters as estimate uint64 little-endian,
+ *                value length uint32 little-endian and value bytes,
+ *                sorted by estimate, biggest first
+ */
+
+#include "pghashlib.h"
+
+#if PG_VERSION_NUM >= 90600
+
+#include "access/htup_details.h"
+#include "catalog/pg_type.h"
+#include "funcapi.h"
+#include "libpq/pqformat.h"
+#include "utils/builtins.h"
+
+#define CMS_VERSION		1
+#define CMS_FLAG_TEXT		1
+#define CMS_ALGO_LEN		16
+#define CMS_HDRSZ		32
+#define CMS_MAX_DEPTH		64
+#define CMS_MAX_COUNTERS	(16 * 1024 * 1024)
+#define CMS_MAX_TOP		1000
+
+struct CmsItem {
+	uint64_t hash[2];
+	uint64_t count;
+	uint32 len;
+	int bucket;		/* slot in index */
+	char *data;
+};
+
+struct CmsState {
+	const struct StrHashDesc *desc;
+	int flags;
+	int depth;
+	int width;
+	int maxtop;
+	int ntop;
+	uint64_t *counters;
+	struct CmsItem *top;	/* min-heap on count */
+	int *index;		/* open addressing on hash[1], heap slot or -1 */
+	int nbuckets;		/* power of 2, at least 2 * maxtop */
+};
+
+PG_FUNCTION_INFO_V1(pg_cms_in);
+PG_FUNCTION_INFO_V1(pg_cms_out);
+PG_FUNCTION_INFO_V1(pg_cms_recv);
+PG_FUNCTION_INFO_V1(pg_cms_send);
+PG_FUNCTION_INFO_V1(pg_cms_add_transfn);
+PG_FUNCTION_INFO_V1(pg_cms_combine);
+PG_FUNCTION_INFO_V1(pg_cms_serial);
+PG_FUNCTION_INFO_V1(pg_cms_deserial);
+PG_FUNCTION_INFO_V1(pg_cms_final);
+PG_FUNCTION_INFO_V1(pg_cms_union);
+PG_FUNCTION_INFO_V1(pg_cms_estimate);
+PG_FUNCTION_INFO_V1(pg_cms_top);
+
+/*
+ * State handling.
+ */
+
+static const struct StrHashDesc *
+cms_hash(const char *name, unsigned nlen)
+{
+	const struct StrHashDesc *desc;
+
+	desc = hlib_find_string_hash(name, nlen);
+	if (desc == NULL)
+		elog(ERROR, "hash '%.*s' not found", nlen, name);
+	if (desc->bits < 128)
+		elog(ERROR, "cms needs 128-bit hash, '%.*s' gives %d bits",
+		     nlen, name, desc->bits);
+	return desc;
+}
+
+static void
+cms_check_params(int width, int depth, int maxtop)
+{
+	if (depth < 1 || depth > CMS_MAX_DEPTH)
+		elog(ERROR, "cms depth must be between 1 and %d", CMS_MAX_DEPTH);
+	if (width < 1 || (int64) width * depth > CMS_MAX_COUNTERS)
+		elog(ERROR, "cms width must be positive and width * depth at most %d",
+		     CMS_MAX_COUNTERS);
+	if (maxtop < 0 || maxtop > CMS_MAX_TOP)
+		elog(ERROR, "cms heavy hitters count must be between 0 and %d", CMS_MAX_TOP);
+}
+
+static struct CmsState *
+cms_create(MemoryContext mcxt, const struct StrHashDesc *desc, int flags,
+	   int width, int depth, int maxtop)
+{
+	struct CmsState *st;
+
+	cms_check_params(width, depth, maxtop);
+
+	st = MemoryContextAllocZero(mcxt, sizeof(*st));
+	st->desc = desc;
+	st->flags = flags;
+	st->width = width;
+	st->depth = depth;
+	st->maxtop = maxtop;
+	st->counters = MemoryContextAllocZero(mcxt, (Size) width * depth * sizeof(uint64_t));
+	if (maxtop > 0) {
+		st->top = MemoryContextAllocZero(mcxt, maxtop * sizeof(struct CmsItem));
+		st->nbuckets = 2;
+		while (st->nbuckets < maxtop * 2)
+			st->nbuckets *= 2;
+		st->index = MemoryContextAlloc(mcxt, st->nbuckets * sizeof(int));
+		memset(st->index, -1, st->nbuckets * sizeof(int));
+	}
+	return st;
+}
+
+/* same as hash128_string(value, algo) */
+static void
+cms_hash_value(const struct StrHashDesc *desc, Datum value, uint64_t *io)
+{
+	memset(io, 0, sizeof(uint64_t) * MAX_IO_VALUES);
+	hlib_hash_varlena(desc->hash, desc->stream, value, io);
+}
+
+static void
+cms_hash_bytes(const struct StrHashDesc *desc, const char *data, int len, uint64_t *io)
+{
+	memset(io, 0, sizeof(uint64_t) * MAX_IO_VALUES);
+	desc->hash(data, len, io);
+}
+
+static uint64_t
+cms_count(const struct CmsState *st, const uint64_t *io)
+{
+	uint64_t h = io[0];
+	uint64_t c, est = UINT64_MAX;
+	int i;
+
+	for (i = 0; i < st->depth; i++) {
+		c = st->counters[(Size) i * st->width + h % st->width];
+		if (c < est)
+			est = c;
+		h += io[1];
+	}
+	return est;
+}
+
+/* add to counters, return new estimate */
+static uint64_t
+cms_increment(struct CmsState *st, const uint64_t *io, uint64_t n)
+{
+	uint64_t h = io[0];
+	uint64_t c, est = UINT64_MAX;
+	int i;
+
+	for (i = 0; i < st->depth; i++) {
+		c = st->counters[(Size) i * st->width + h % st->width] += n;
+		if (c < est)
+			est = c;
+		h += io[1];
+	}
+	return est;
+}
+
+/*
+ * Heavy hitters list.
+ */
+
+/* put item to heap slot, keeping index in sync */
+static void
+cms_heap_set(struct CmsState *st, int pos, const struct CmsItem *item)
+{
+	st->top[pos] = *item;
+	st->index[item->bucket] = pos;
+}
+
+/* restore heap order after count of item in pos changed */
+static void
+cms_heap_fix(struct CmsState *st, int pos)
+{
+	struct CmsItem tmp = st->top[pos];
+	int child;
+
+	while (pos > 0 && st->top[(pos - 1) / 2].count > tmp.count) {
+		cms_heap_set(st, pos, &st->top[(pos - 1) / 2]);
+		pos = (pos - 1) / 2;
+	}
+	while ((child = pos * 2 + 1) < st->ntop) {
+		if (child + 1 < st->ntop && st->top[child + 1].count < st->top[child].count)
+			child++;
+		if (st->top[child].count >= tmp.count)
+			break;
+		cms_heap_set(st, pos, &st->top[child]);
+		pos = child;
+	}
+	cms_heap_set(st, pos, &tmp);
+}
+
+/* heap slot of value or -1, *bucket gets its index slot or free one */
+static int
+cms_index_find(const struct CmsState *st, const uint64_t *io,
+	       const char *data, int len, int *bucket)
+{
+	int mask = st->nbuckets - 1;
+	int b = io[1] & mask;
+	const struct CmsItem *item;
+	int pos;
+
+	while ((pos = st->index[b]) >= 0) {
+		item = &st->top[pos];
+		if (item->hash[0] == io[0] && item->hash[1] == io[1]
+		    && item->len == len && memcmp(item->data, data, len) == 0)
+			break;
+		b = (b + 1) & mask;
+	}
+	*bucket = b;
+	return pos;
+}
+
+/* free index slot, later entries are moved back so probing stays valid */
+static void
+cms_index_delete(struct CmsState *st, int hole)
+{
+	int mask = st->nbuckets - 1;
+	int b = hole;
+	int pos, home;
+
+	st->index[hole] = -1;
+	for (;;) {
+		b = (b + 1) & mask;
+		pos = st->index[b];
+		if (pos < 0)
+			break;
+		home = st->top[pos].hash[1] & mask;
+		if (((b - home) & mask) >= ((b - hole) & mask)) {
+			st->index[hole] = pos;
+			st->top[pos].bucket = hole;
+			st->index[b] = -1;
+			hole = b;
+		}
+	}
+}
+
+/* update heavy hitters list with new estimate for value */
+static void
+cms_top_update(struct CmsState *st, MemoryContext mcxt, const uint64_t *io,
+	       const char *data, int len, uint64_t count)
+{
+	struct CmsItem *item;
+	int pos, bucket;
+
+	pos = cms_index_find(st, io, data, len, &bucket);
+	if (pos >= 0) {
+		st->top[pos].count = count;
+		cms_heap_fix(st, pos);
+		return;
+	}
+
+	if (st->ntop < st->maxtop) {
+		pos = st->ntop++;
+	} else {
+		/* replace smallest, if new one is bigger */
+		pos = 0;
+		if (st->top[0].count >= count)
+			return;
+		pfree(st->top[0].data);
+		cms_index_delete(st, st->top[0].bucket);
+		cms_index_find(st, io, data, len, &bucket);
+	}
+
+	item = &st->top[pos];
+	item->hash[0] = io[0];
+	item->hash[1] = io[1];
+	item->count = count;
+	item->len = len;
+	item->bucket = bucket;
+	item->data = MemoryContextAlloc(mcxt, Max(len, 1));
+	memcpy(item->data, data, len);
+	st->index[bucket] = pos;
+	cms_heap_fix(st, pos);
+}
+
+static void
+cms_merge(struct CmsState *dst, MemoryContext mcxt, const struct CmsState *src)
+{
+	Size i, n = (Size) dst->width * dst->depth;
+	int ntop = dst->ntop;
+	const struct CmsItem *item;
+
+	if (dst->desc != src->desc || dst->width != src->width || dst->depth != src->depth
+	    || dst->maxtop != src->maxtop || dst->flags != src->flags)
+		elog(ERROR, "cannot combine cms sketches with different parameters");
+
+	for (i = 0; i < n; i++)
+		dst->counters[i] += src->counters[i];
+
+	/* candidates from both lists, with estimates from merged counters */
+	for (i = 0; i < ntop; i++)
+		dst->top[i].count = cms_count(dst, dst->top[i].hash);
+	/* estimates changed, rebuild heap by inserting items one by one */
+	for (i = 1; i <= ntop; i++) {
+		dst->ntop = i;
+		cms_heap_fix(dst, i - 1);
+	}
+	for (i = 0; i < src->ntop; i++) {
+		item = &src->top[i];
+		cms_top_update(dst, mcxt, item->hash, item->data, item->len,
+			       cms_count(dst, item->hash));
+	}
+}
+
+/*
+ * Binary format.
+ */
+
+static int
+cmp_item(const void *a, const void *b)
+{
+	const struct CmsItem *i1 = a;
+	const struct CmsItem *i2 = b;
+	int res;
+
+	if (i1->count != i2->count)
+		return (i1->count > i2->count) ? -1 : 1;
+	res = memcmp(i1->data, i2->data, Min(i1->len, i2->len));
+	if (res != 0)
+		return res;
+	return (i1->len < i2->len) ? -1 : (i1->len > i2->len) ? 1 : 0;
+}
+
+/* heavy hitters biggest first, heap itself stays as is */
+static struct CmsItem *
+cms_sorted_top(const struct CmsState *st)
+{
+	struct CmsItem *items;
+
+	items = palloc(Max(st->ntop, 1) * sizeof(struct CmsItem));
+	memcpy(items, st->top, st->ntop * sizeof(struct CmsItem));
+	if (st->ntop > 1)
+		qsort(items, st->ntop, sizeof(struct CmsItem), cmp_item);
+	return items;
+}
+
+static bytea *
+cms_serialize(struct CmsState *st)
+{
+	StringInfoData buf;
+	char algo[CMS_ALGO_LEN];
+	Size i, n = (Size) st->width * st->depth;
+	struct CmsItem *top = cms_sorted_top(st);
+
+	memset(algo, 0, sizeof(algo));
+	memcpy(algo, st->desc->name, st->desc->namelen);
+
+	pq_begintypsend(&buf);
+	enlargeStringInfo(&buf, CMS_HDRSZ + n * 8);
+	pq_sendbyte(&buf, CMS_VERSION);
+	pq_sendbyte(&buf, st->flags);
+	pq_sendbyte(&buf, st->depth & 0xFF);
+	pq_sendbyte(&buf, st->depth >> 8);
+	hlib_put_le32(&buf, st->width);
+	hlib_put_le32(&buf, st->maxtop);
+	hlib_put_le32(&buf, st->ntop);
+	pq_sendbytes(&buf, algo, CMS_ALGO_LEN);
+	for (i = 0; i < n; i++)
+		hlib_put_le64(&buf, st->counters[i]);
+	for (i = 0; i < st->ntop; i++) {
+		hlib_put_le64(&buf, top[i].count);
+		hlib_put_le32(&buf, top[i].len);
+		pq_sendbytes(&buf, top[i].data, top[i].len);
+	}
+	pfree(top);
+	return pq_endtypsend(&buf);
+}
+
+/* parse header, leaves cursor at counters */
+static struct CmsState *
+cms_read_header(StringInfo buf, struct CmsState *hdr)
+{
+	int depth;
+
+	if (buf->len < CMS_HDRSZ || pq_getmsgbyte(buf) != CMS_VERSION)
+		elog(ERROR, "invalid cms sketch: unsupported version");
+	hdr->flags = pq_getmsgbyte(buf);
+	depth = pq_getmsgbyte(buf);
+	depth |= pq_getmsgbyte(buf) << 8;
+	hdr->depth = depth;
+	hdr->width = hlib_get_le32(buf);
+	hdr->maxtop = hlib_get_le32(buf);
+	hdr->ntop = hlib_get_le32(buf);
+	hdr->desc = cms_hash(buf->data + buf->cursor, strnlen(buf->data + buf->cursor, CMS_ALGO_LEN));
+	buf->cursor += CMS_ALGO_LEN;
+
+	if ((int32) hdr->width < 1 || hdr->depth < 1 || hdr->depth > CMS_MAX_DEPTH
+	    || (int64) hdr->width * hdr->depth > CMS_MAX_COUNTERS
+	    || (uint32) hdr->maxtop > CMS_MAX_TOP || (uint32) hdr->ntop > (uint32) hdr->maxtop
+	    || (hdr->flags & ~CMS_FLAG_TEXT) != 0)
+		elog(ERROR, "invalid cms sketch: bad parameters");
+	if (buf->len - buf->cursor < (int64) hdr->width * hdr->depth * 8)
+		elog(ERROR, "invalid cms sketch: bad size");
+	return hdr;
+}
+
+static struct CmsState *
+cms_deserialize(MemoryContext mcxt, const char *data, int len)
+{
+	struct CmsState hdr;
+	struct CmsState *st;
+	StringInfoData buf;
+	uint64_t io[MAX_IO_VALUES];
+	Size i, n;
+	uint64_t count;
+	uint32 vlen;
+	const char *val;
+#ifndef HLIB_UNALIGNED_READ_OK
+	char *scratch = NULL;
+	uint32 scratchlen = 0;
+#endif
+
+	buf.data = (char *) data;
+	buf.len = len;
+	buf.maxlen = len;
+	buf.cursor = 0;
+
+	cms_read_header(&buf, &hdr);
+	st = cms_create(mcxt, hdr.desc, hdr.flags, hdr.width, hdr.depth, hdr.maxtop);
+
+	n = (Size) st->width * st->depth;
+	for (i = 0; i < n; i++)
+		st->counters[i] = hlib_get_le64(&buf);
+
+	for (i = 0; i < hdr.ntop; i++) {
+		count = hlib_get_le64(&buf);
+		vlen = hlib_get_le32(&buf);
+		val = pq_getmsgbytes(&buf, vlen);
+#ifndef HLIB_UNALIGNED_READ_OK
+		/* values are packed without padding, hash aligned copy */
+		if (vlen > 0) {
+			if (vlen > scratchlen) {
+				if (scratch)
+					pfree(scratch);
+				scratchlen = vlen;
+				scratch = palloc(scratchlen);
+			}
+			memcpy(scratch, val, vlen);
+			val = scratch;
+		}
+#endif
+		cms_hash_bytes(st->desc, val, vlen, io);
+		cms_top_update(st, mcxt, io, val, vlen, count);
+	}
+#ifndef HLIB_UNALIGNED_READ_OK
+	if (scratch)
+		pfree(scratch);
+#endif
+	if (st->ntop != hdr.ntop)
+		elog(ERROR, "invalid cms sketch: duplicate heavy hitters");
+	pq_getmsgend(&buf);
+	return st;
+}
+
+static struct CmsState *
+cms_from_datum(MemoryContext mcxt, Datum value)
+{
+	bytea *data = DatumGetByteaPP(value);
+
+	return cms_deserialize(mcxt, VARDATA_ANY(data), VARSIZE_ANY_EXHDR(data));
+}
+
+#define PG_GETARG_CMS(n, mcxt) cms_from_datum(mcxt, PG_GETARG_DATUM(n))
+
+/*
+ * Type I/O.
+ */
+
+/* cms_in(cstring) returns cms */
+Datum
+pg_cms_in(PG_FUNCTION_ARGS)
+{
+	const char *str = PG_GETARG_CSTRING(0);
+	bytea *res;
+
+	res = hlib_hex_in(str, "cms sketch");
+	cms_deserialize(CurrentMemoryContext, VARDATA(res), VARSIZE(res) - VARHDRSZ);
+	PG_RETURN_BYTEA_P(res);
+}
+
+/* cms_out(cms) returns cstring */
+Datum
+pg_cms_out(PG_FUNCTION_ARGS)
+{
+	bytea *data = PG_GETARG_BYTEA_PP(0);
+
+	PG_RETURN_CSTRING(hlib_hex_out(VARDATA_ANY(data), VARSIZE_ANY_EXHDR(data)));
+}
+
+/* cms_recv(internal) returns cms */
+Datum
+pg_cms_recv(PG_FUNCTION_ARGS)
+{
+	StringInfo buf = (StringInfo) PG_GETARG_POINTER(0);
+	int len = buf->len - buf->cursor;
+	bytea *res;
+
+	res = palloc(VARHDRSZ + len);
+	SET_VARSIZE(res, VARHDRSZ + len);
+	pq_copymsgbytes(buf, VARDATA(res), len);
+	cms_deserialize(CurrentMemoryContext, VARDATA(res), len);
+	PG_RETURN_BYTEA_P(res);
+}
+
+/* cms_send(cms) returns bytea */
+Datum
+pg_cms_send(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_BYTEA_P(PG_GETARG_BYTEA_P(0));
+}
+
+/*
+ * Aggregates.
+ */
+
+/* cms_add_transfn(internal, bytea, int4, int4 [, text [, int4]]) returns internal */
+Datum
+pg_cms_add_transfn(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggctx = hlib_agg_context(fcinfo, "cms_add_transfn");
+	struct CmsState *st;
+	struct varlena *data;
+	uint64_t io[MAX_IO_VALUES];
+	uint64_t count;
+
+	st = PG_ARGISNULL(0) ? NULL : (struct CmsState *) PG_GETARG_POINTER(0);
+	if (st == NULL) {
+		const struct StrHashDesc *desc;
+		int flags = 0;
+		int i;
+
+		for (i = 2; i < PG_NARGS(); i++) {
+			if (PG_ARGISNULL(i))
+				elog(ERROR, "cms parameters must not be NULL");
+		}
+		if (PG_NARGS() >= 5) {
+			text *hashname = PG_GETARG_TEXT_PP(4);
+
+			desc = cms_hash(VARDATA_ANY(hashname), VARSIZE_ANY_EXHDR(hashname));
+		} else {
+			desc = cms_hash("city128", 7);
+		}
+		if (get_fn_expr_argtype(fcinfo->flinfo, 1) == TEXTOID)
+			flags |= CMS_FLAG_TEXT;
+
+		st = cms_create(aggctx, desc, flags, PG_GETARG_INT32(2), PG_GETARG_INT32(3),
+				(PG_NARGS() >= 6) ? PG_GETARG_INT32(5) : 0);
+	}
+	if (PG_ARGISNULL(1))
+		PG_RETURN_POINTER(st);
+
+	cms_hash_value(st->desc, PG_GETARG_DATUM(1), io);
+	count = cms_increment(st, io, 1);
+
+	if (st->maxtop > 0) {
+		data = PG_GETARG_VARLENA_PP(1);
+		cms_top_update(st, aggctx, io, VARDATA_ANY(data), VARSIZE_ANY_EXHDR(data), count);
+		PG_FREE_IF_COPY(data, 1);
+	}
+
+	PG_RETURN_POINTER(st);
+}
+
+/* cms_combine(internal, internal) returns internal */
+Datum
+pg_cms_combine(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggctx = hlib_agg_context(fcinfo, "cms_combine");
+	struct CmsState *st1, *st2;
+
+	st1 = PG_ARGISNULL(0) ? NULL : (struct CmsState *) PG_GETARG_POINTER(0);
+	st2 = PG_ARGISNULL(1) ? NULL : (struct CmsState *) PG_GETARG_POINTER(1);
+
+	if (st2 == NULL) {
+		if (st1 == NULL)
+			PG_RETURN_NULL();
+		PG_RETURN_POINTER(st1);
+	}
+	if (st1 == NULL) {
+		st1 = cms_create(aggctx, st2->desc, st2->flags, st2->width, st2->depth, st2->maxtop);
+		cms_merge(st1, aggctx, st2);
+		PG_RETURN_POINTER(st1);
+	}
+	cms_merge(st1, aggctx, st2);
+	PG_RETURN_POINTER(st1);
+}
+
+/* cms_serial(internal) returns bytea */
+Datum
+pg_cms_serial(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_BYTEA_P(cms_serialize((struct CmsState *) PG_GETARG_POINTER(0)));
+}
+
+/* cms_deserial(bytea, internal) returns internal */
+Datum
+pg_cms_deserial(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggctx = hlib_agg_context(fcinfo, "cms_deserial");
+
+	PG_RETURN_POINTER(PG_GETARG_CMS(0, aggctx));
+}
+
+/* cms_final(internal) returns cms */
+Datum
+pg_cms_final(PG_FUNCTION_ARGS)
+{
+	if (PG_ARGISNULL(0))
+		PG_RETURN_NULL();
+	PG_RETURN_BYTEA_P(cms_serialize((struct CmsState *) PG_GETARG_POINTER(0)));
+}
+
+/*
+ * Functions.
+ */
+
+/* cms_union(cms, cms) returns cms */
+Datum
+pg_cms_union(PG_FUNCTION_ARGS)
+{
+	struct CmsState *st1 = PG_GETARG_CMS(0, CurrentMemoryContext);
+	struct CmsState *st2 = PG_GETARG_CMS(1, CurrentMemoryContext);
+
+	cms_merge(st1, CurrentMemoryContext, st2);
+	PG_RETURN_BYTEA_P(cms_serialize(st1));
+}
+
+/* cms_estimate(cms, bytea) returns int8 */
+Datum
+pg_cms_estimate(PG_FUNCTION_ARGS)
+{
+	bytea *data = PG_GETARG_BYTEA_PP(0);
+	struct CmsState hdr;
+	StringInfoData buf;
+	uint64_t io[MAX_IO_VALUES];
+	uint64_t h, c, est = UINT64_MAX;
+	const char *counters;
+	int i;
+
+	/* read counters in place, without copying whole sketch */
+	buf.data = VARDATA_ANY(data);
+	buf.len = VARSIZE_ANY_EXHDR(data);
+	buf.maxlen = buf.len;
+	buf.cursor = 0;
+	cms_read_header(&buf, &hdr);
+	counters = buf.data + buf.cursor;
+
+	cms_hash_value(hdr.desc, PG_GETARG_DATUM(1), io);
+	h = io[0];
+	for (i = 0; i < hdr.depth; i++) {
+		memcpy(&c, counters + ((Size) i * hdr.width + h % hdr.width) * 8, 8);
+		c = le64toh(c);
+		if (c < est)
+			est = c;
+		h += io[1];
+	}
+	PG_RETURN_INT64(est);
+}
+
+/* cms_top(cms) returns setof record(value text, estimate int8) */
+Datum
+pg_cms_top(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	struct CmsState *st;
+	struct CmsItem *item;
+	Datum values[2];
+	bool nulls[2] = { false, false };
+	HeapTuple tuple;
+
+	if (SRF_IS_FIRSTCALL()) {
+		MemoryContext oldctx;
+		TupleDesc tupdesc;
+
+		funcctx = SRF_FIRSTCALL_INIT();
+		oldctx = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+			elog(ERROR, "return type must be a row type");
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+		/* list in state is heap, return it sorted */
+		st = PG_GETARG_CMS(0, funcctx->multi_call_memory_ctx);
+		st->top = cms_sorted_top(st);
+		funcctx->user_fctx = st;
+		MemoryContextSwitchTo(oldctx);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	st = funcctx->user_fctx;
+	if (funcctx->call_cntr >= st->ntop)
+		SRF_RETURN_DONE(funcctx);
+
+	item = &st->top[funcctx->call_cntr];
+	if (st->flags & CMS_FLAG_TEXT) {
+		values[0] = PointerGetDatum(cstring_to_text_with_len(item->data, item->len));
+	} else {
+		bytea *val = palloc(VARHDRSZ + item->len);
+
+		SET_VARSIZE(val, VARHDRSZ + item->len);
+		memcpy(VARDATA(val), item->data, item->len);
+		values[0] = CStringGetTextDatum(DatumGetCString(DirectFunctionCall1(byteaout, PointerGetDatum(val))));
+	}
+	values[1] = Int64GetDatum(item->count);
+
+	tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+	SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
+
+#endif
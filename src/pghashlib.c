@@ -1,59 +1,71 @@
 
 #include "pghashlib.h"
 
+#include "access/tupmacs.h"
+#include "catalog/pg_type.h"
+#include "utils/array.h"
 #include "utils/builtins.h"
 
+#if PG_VERSION_NUM >= 120000
+#include <math.h>
+
+#include "catalog/pg_collation.h"
+#include "nodes/makefuncs.h"
+#include "nodes/nodeFuncs.h"
+#include "nodes/supportnodes.h"
+#include "optimizer/cost.h"
+#include "parser/parse_func.h"
+#include "utils/lsyscache.h"
+#endif
+
 PG_MODULE_MAGIC;
 
 PG_FUNCTION_INFO_V1(pg_hash_string);
 PG_FUNCTION_INFO_V1(pg_hash64_string);
 PG_FUNCTION_INFO_V1(pg_hash128_string);
+PG_FUNCTION_INFO_V1(pg_hash256_string);
+PG_FUNCTION_INFO_V1(pg_hash_string_array);
+PG_FUNCTION_INFO_V1(pg_hash64_string_array);
+PG_FUNCTION_INFO_V1(pg_hash128_string_array);
 PG_FUNCTION_INFO_V1(pg_hash_int32);
 PG_FUNCTION_INFO_V1(pg_hash_int32from64);
 PG_FUNCTION_INFO_V1(pg_hash_int64);
+PG_FUNCTION_INFO_V1(pg_crc32_combine);
+PG_FUNCTION_INFO_V1(pg_crc32c_combine);
+PG_FUNCTION_INFO_V1(pg_hashlib_support);
 
 /*
  * Algorithm data
  */
 
-#define HASHNAMELEN 12
-
-struct StrHashDesc {
-	int namelen;
-	const char name[HASHNAMELEN];
-	hlib_str_hash_fn hash;
-	uint64_t initval;
-};
-
-struct Int32HashDesc {
-	int namelen;
-	const char name[HASHNAMELEN];
-	hlib_int32_hash_fn hash;
-};
-
-struct Int64HashDesc {
-	int namelen;
-	const char name[HASHNAMELEN];
-	hlib_int64_hash_fn hash;
-};
-
 static const struct StrHashDesc string_hash_list[] = {
-	{ 7, "lookup2",		hlib_lookup2_hash, 3923095 },
+	{ 7, "lookup2",		hlib_lookup2_hash, 64, 3923095, 1.0 },
 #ifdef WORDS_BIGENDIAN
-	{ 7, "lookup3",		hlib_lookup3_hashbig, 0 },
+	{ 7, "lookup3",		hlib_lookup3_hashbig, 64, 0, 1.0 },
 #else
-	{ 7, "lookup3",		hlib_lookup3_hashlittle, 0 },
+	{ 7, "lookup3",		hlib_lookup3_hashlittle, 64, 0, 1.0 },
 #endif
-	{ 9, "lookup3le",	hlib_lookup3_hashlittle, 0 },
-	{ 9, "lookup3be",	hlib_lookup3_hashbig,	0 },
-	{ 9, "siphash24",	hlib_siphash24, 0 },
-	{ 7, "murmur3",		hlib_murmur3, 0 },
-	{ 6, "city64",		hlib_cityhash64, 0 },
-	{ 7, "city128",		hlib_cityhash128, 0 },
-	{ 6, "spooky",		hlib_spookyhash, 0 },
-	{ 7, "pgsql84",		hlib_pgsql84, 0 },
-	{ 3, "md5",		hlib_md5, 0 },
-	{ 5, "crc32",		hlib_crc32, 0 },
+	{ 9, "lookup3le",	hlib_lookup3_hashlittle, 64, 0, 1.0 },
+	{ 9, "lookup3be",	hlib_lookup3_hashbig, 64, 0, 1.0 },
+	{ 9, "siphash24",	hlib_siphash24, 64, 0, 1.5, &hlib_siphash24_stream },
+	{ 13, "siphash24_128",	hlib_siphash24_128, 128, 0, 1.8 },
+	{ 9, "siphash13",	hlib_siphash13, 64, 0, 1.0, &hlib_siphash13_stream },
+	{ 13, "halfsiphash13",	hlib_halfsiphash13, 32, 0, 1.5 },
+	{ 7, "murmur3",		hlib_murmur3, 32, 0, 1.0, &hlib_murmur3_stream },
+	{ 11, "murmur3_128",	hlib_murmur3_128, 128, 0, 0.5 },
+	{ 15, "murmur3_x86_128",	hlib_murmur3_x86_128, 128, 0, 0.7 },
+	{ 6, "city64",		hlib_cityhash64, 64, 0, 0.5 },
+	{ 7, "city128",		hlib_cityhash128, 128, 0, 0.5 },
+	{ 10, "citycrc128",	hlib_citycrc128, 128, 0, 0.4 },
+	{ 10, "citycrc256",	hlib_citycrc256_128, 256, 0, 0.4, NULL, hlib_citycrc256 },
+	{ 6, "spooky",		hlib_spookyhash, 128, 0, 0.5, &hlib_spookyhash_stream },
+	{ 7, "pgsql84",		hlib_pgsql84, 64, 0, 1.0 },
+	{ 3, "md5",		hlib_md5, 128, 0, 5.0, &hlib_md5_stream },
+	{ 5, "crc32",		hlib_crc32, 32, 0, 1.0, &hlib_crc32_stream },
+	{ 6, "crc32c",		hlib_crc32c, 32, 0, 0.5, &hlib_crc32c_stream },
+	{ 5, "xxh64",		hlib_xxh64, 64, 0, 0.5, &hlib_xxh64_stream },
+	{ 7, "xxh3_64",		hlib_xxh3_64, 64, 0, 0.3, &hlib_xxh3_64_stream },
+	{ 8, "xxh3_128",	hlib_xxh3_128, 128, 0, 0.3, &hlib_xxh3_128_stream },
 	{ 0 },
 };
 
@@ -65,8 +77,8 @@ static const struct Int32HashDesc int32_hash_list[] = {
 };
 
 static const struct Int64HashDesc int64_hash_list[] = {
-	{ 6, "wang64",		hlib_int64_wang },
-	{ 10, "wang64to32",	hlib_int64to32_wang },
+	{ 6, "wang64",		hlib_int64_wang, 64 },
+	{ 10, "wang64to32",	hlib_int64to32_wang, 32 },
 	{ 0 },
 };
 
@@ -74,8 +86,8 @@ static const struct Int64HashDesc int64_hash_list[] = {
  * Lookup functions.
  */
 
-static const struct StrHashDesc *
-find_string_hash(const char *name, unsigned nlen)
+const struct StrHashDesc *
+hlib_find_string_hash(const char *name, unsigned nlen)
 {
 	const struct StrHashDesc *desc;
 	char buf[HASHNAMELEN];
@@ -96,8 +108,8 @@ find_string_hash(const char *name, unsigned nlen)
 	return NULL;
 }
 
-static const struct Int32HashDesc *
-find_int32_hash(const char *name, unsigned nlen)
+const struct Int32HashDesc *
+hlib_find_int32_hash(const char *name, unsigned nlen)
 {
 	const struct Int32HashDesc *desc;
 	char buf[HASHNAMELEN];
@@ -114,8 +126,8 @@ find_int32_hash(const char *name, unsigned nlen)
 	return NULL;
 }
 
-static const struct Int64HashDesc *
-find_int64_hash(const char *name, unsigned nlen)
+const struct Int64HashDesc *
+hlib_find_int64_hash(const char *name, unsigned nlen)
 {
 	const struct Int64HashDesc *desc;
 	char buf[HASHNAMELEN];
@@ -144,6 +156,121 @@ err_nohash(text *hashname)
 	elog(ERROR, "hash '%s' not found", name);
 }
 
+/*
+ * Algorithm name is almost always constant, so remember
+ * last resolved descriptor in fn_extra.
+ */
+
+struct HashCache {
+	const void *desc;
+	unsigned namelen;
+	char name[HASHNAMELEN];
+};
+
+static const void *
+cache_lookup(FunctionCallInfo fcinfo, const char *name, unsigned nlen)
+{
+	struct HashCache *cache = fcinfo->flinfo->fn_extra;
+
+	if (cache == NULL || cache->namelen != nlen)
+		return NULL;
+	if (memcmp(cache->name, name, nlen) != 0)
+		return NULL;
+	return cache->desc;
+}
+
+static void
+cache_store(FunctionCallInfo fcinfo, const char *name, unsigned nlen, const void *desc)
+{
+	struct HashCache *cache = fcinfo->flinfo->fn_extra;
+
+	/* descriptors are found only for short names */
+	if (nlen >= HASHNAMELEN)
+		return;
+
+	if (cache == NULL) {
+		cache = MemoryContextAlloc(fcinfo->flinfo->fn_mcxt, sizeof(*cache));
+		fcinfo->flinfo->fn_extra = cache;
+	}
+	cache->desc = desc;
+	cache->namelen = nlen;
+	memcpy(cache->name, name, nlen);
+}
+
+const struct StrHashDesc *
+hlib_load_string_hash(FunctionCallInfo fcinfo, text *hashname)
+{
+	const char *name = VARDATA_ANY(hashname);
+	unsigned nlen = VARSIZE_ANY_EXHDR(hashname);
+	const struct StrHashDesc *desc;
+
+	desc = cache_lookup(fcinfo, name, nlen);
+	if (desc == NULL) {
+		desc = hlib_find_string_hash(name, nlen);
+		if (desc == NULL)
+			err_nohash(hashname);
+		cache_store(fcinfo, name, nlen, desc);
+	}
+	return desc;
+}
+
+const struct Int32HashDesc *
+hlib_load_int32_hash(FunctionCallInfo fcinfo, text *hashname)
+{
+	const char *name = VARDATA_ANY(hashname);
+	unsigned nlen = VARSIZE_ANY_EXHDR(hashname);
+	const struct Int32HashDesc *desc;
+
+	desc = cache_lookup(fcinfo, name, nlen);
+	if (desc == NULL) {
+		desc = hlib_find_int32_hash(name, nlen);
+		if (desc == NULL)
+			err_nohash(hashname);
+		cache_store(fcinfo, name, nlen, desc);
+	}
+	return desc;
+}
+
+const struct Int64HashDesc *
+hlib_load_int64_hash(FunctionCallInfo fcinfo, text *hashname)
+{
+	const char *name = VARDATA_ANY(hashname);
+	unsigned nlen = VARSIZE_ANY_EXHDR(hashname);
+	const struct Int64HashDesc *desc;
+
+	desc = cache_lookup(fcinfo, name, nlen);
+	if (desc == NULL) {
+		desc = hlib_find_int64_hash(name, nlen);
+		if (desc == NULL)
+			err_nohash(hashname);
+		cache_store(fcinfo, name, nlen, desc);
+	}
+	return desc;
+}
+
+/* hash varlena datum, big toasted values are streamed if possible */
+void
+hlib_hash_varlena(hlib_str_hash_fn hash, const struct HashStreamOps *stream,
+		  Datum value, uint64_t *io)
+{
+	struct varlena *data;
+
+	if (hlib_hash_toasted(stream, value, io))
+		return;
+
+	/* request aligned data on weird architectures */
+#ifdef HLIB_UNALIGNED_READ_OK
+	data = PG_DETOAST_DATUM_PACKED(value);
+#else
+	data = PG_DETOAST_DATUM(value);
+#endif
+
+	hash(VARDATA_ANY(data), VARSIZE_ANY_EXHDR(data), io);
+
+	if ((Pointer) data != DatumGetPointer(value))
+		pfree(data);
+}
+
 /*
  * Public functions
  */
@@ -152,24 +279,14 @@ err_nohash(text *hashname)
 Datum
 pg_hash_string(PG_FUNCTION_ARGS)
 {
-	struct varlena *data;
 	text *hashname = PG_GETARG_TEXT_PP(1);
 	const struct StrHashDesc *desc;
 	uint64_t io[MAX_IO_VALUES];
 
 	memset(io, 0, sizeof(io));
 
-	/* request aligned data on weird architectures */
-#ifdef HLIB_UNALIGNED_READ_OK
-	data = PG_GETARG_VARLENA_PP(0);
-#else
-	data = PG_GETARG_VARLENA_P(0);
-#endif
-
 	/* load hash */
-	desc = find_string_hash(VARDATA_ANY(hashname), VARSIZE_ANY_EXHDR(hashname));
-	if (desc == NULL)
-		err_nohash(hashname);
+	desc = hlib_load_string_hash(fcinfo, hashname);
 
 	/* decide initval */
 	if (PG_NARGS() >= 3)
@@ -178,9 +295,8 @@ pg_hash_string(PG_FUNCTION_ARGS)
 		io[0] = desc->initval;
 
 	/* do hash */
-	desc->hash(VARDATA_ANY(data), VARSIZE_ANY_EXHDR(data), io);
+	hlib_hash_varlena(desc->hash, desc->stream, PG_GETARG_DATUM(0), io);
 
-	PG_FREE_IF_COPY(data, 0);
 	PG_FREE_IF_COPY(hashname, 1);
 
 	PG_RETURN_INT32(io[0]);
@@ -190,24 +306,14 @@ pg_hash_string(PG_FUNCTION_ARGS)
 Datum
 pg_hash64_string(PG_FUNCTION_ARGS)
 {
-	struct varlena *data;
 	text *hashname = PG_GETARG_TEXT_PP(1);
 	uint64_t io[MAX_IO_VALUES];
 	const struct StrHashDesc *desc;
 
 	memset(io, 0, sizeof(io));
 
-	/* request aligned data on weird architectures */
-#ifdef HLIB_UNALIGNED_READ_OK
-	data = PG_GETARG_VARLENA_PP(0);
-#else
-	data = PG_GETARG_VARLENA_P(0);
-#endif
-
 	/* load hash */
-	desc = find_string_hash(VARDATA_ANY(hashname), VARSIZE_ANY_EXHDR(hashname));
-	if (desc == NULL)
-		err_nohash(hashname);
+	desc = hlib_load_string_hash(fcinfo, hashname);
 
 	/* decide initvals */
 	if (PG_NARGS() >= 4)
@@ -218,9 +324,8 @@ pg_hash64_string(PG_FUNCTION_ARGS)
 		io[0] = desc->initval;
 
 	/* do hash */
-	desc->hash(VARDATA_ANY(data), VARSIZE_ANY_EXHDR(data), io);
+	hlib_hash_varlena(desc->hash, desc->stream, PG_GETARG_DATUM(0), io);
 
-	PG_FREE_IF_COPY(data, 0);
 	PG_FREE_IF_COPY(hashname, 1);
 
 	PG_RETURN_INT64(io[0]);
@@ -230,7 +335,6 @@ pg_hash64_string(PG_FUNCTION_ARGS)
 Datum
 pg_hash128_string(PG_FUNCTION_ARGS)
 {
-	struct varlena *data;
 	text *hashname = PG_GETARG_TEXT_PP(1);
 	const struct StrHashDesc *desc;
 	uint64_t io[MAX_IO_VALUES];
@@ -238,17 +342,8 @@ pg_hash128_string(PG_FUNCTION_ARGS)
 
 	memset(io, 0, sizeof(io));
 
-	/* request aligned data on weird architectures */
-#ifdef HLIB_UNALIGNED_READ_OK
-	data = PG_GETARG_VARLENA_PP(0);
-#else
-	data = PG_GETARG_VARLENA_P(0);
-#endif
-
 	/* load hash */
-	desc = find_string_hash(VARDATA_ANY(hashname), VARSIZE_ANY_EXHDR(hashname));
-	if (desc == NULL)
-		err_nohash(hashname);
+	desc = hlib_load_string_hash(fcinfo, hashname);
 
 	/* decide initval */
 	if (PG_NARGS() > 2)
@@ -257,9 +352,8 @@ pg_hash128_string(PG_FUNCTION_ARGS)
 		io[1] = PG_GETARG_INT64(3);
 
 	/* do hash */
-	desc->hash(VARDATA_ANY(data), VARSIZE_ANY_EXHDR(data), io);
+	hlib_hash_varlena(desc->hash, desc->stream, PG_GETARG_DATUM(0), io);
 
-	PG_FREE_IF_COPY(data, 0);
 	PG_FREE_IF_COPY(hashname, 1);
 
 	/* always output little-endian */
@@ -273,6 +367,219 @@ pg_hash128_string(PG_FUNCTION_ARGS)
 	PG_RETURN_BYTEA_P(res);
 }
 
+/*
+ * hash256_string(bytea, text) returns bytea
+ *
+ * Only for algorithms with wider output than io array,
+ * value is detoasted whole.
+ */
+Datum
+pg_hash256_string(PG_FUNCTION_ARGS)
+{
+	text *hashname = PG_GETARG_TEXT_PP(1);
+	const struct StrHashDesc *desc;
+	uint64_t out[HASH256_VALUES];
+	struct varlena *data;
+	bytea *res;
+	int i;
+
+	/* load hash */
+	desc = hlib_load_string_hash(fcinfo, hashname);
+	if (desc->hash256 == NULL)
+		elog(ERROR, "hash '%s' does not support 256-bit output",
+		     text_to_cstring(hashname));
+
+	/* do hash */
+	data = PG_GETARG_VARLENA_PP(0);
+	desc->hash256(VARDATA_ANY(data), VARSIZE_ANY_EXHDR(data), out);
+
+	PG_FREE_IF_COPY(data, 0);
+	PG_FREE_IF_COPY(hashname, 1);
+
+	/* always output little-endian */
+	for (i = 0; i < HASH256_VALUES; i++)
+		out[i] = htole64(out[i]);
+
+	res = palloc(VARHDRSZ + 32);
+	SET_VARSIZE(res, VARHDRSZ + 32);
+	memcpy(VARDATA(res), out, 32);
+
+	PG_RETURN_BYTEA_P(res);
+}
+
+/*
+ * Array hashing.
+ *
+ * Algorithm is resolved once, elements are hashed in one loop
+ * and result array is allocated in one go.
+ */
+
+#define HASH128_ELEM_SIZE	INTALIGN(VARHDRSZ + 16)
+
+static Datum
+hash_string_array(FunctionCallInfo fcinfo, int bits)
+{
+	ArrayType *arr = PG_GETARG_ARRAYTYPE_P(0);
+	text *hashname = PG_GETARG_TEXT_PP(1);
+	const struct StrHashDesc *desc;
+	uint64_t iv[MAX_IO_VALUES];
+	uint64_t io[MAX_IO_VALUES];
+	int ndim = ARR_NDIM(arr);
+	int nitems = ArrayGetNItems(ndim, ARR_DIMS(arr));
+	bits8 *bitmap = ARR_NULLBITMAP(arr);
+	int bitmask;
+	int nvalues = nitems;
+	int i;
+	Oid restype;
+	int elemsize;
+	Size dataoffset;
+	Size size;
+	ArrayType *res;
+	const char *src;
+	char *dst;
+	const char *data;
+	Size len;
+#ifndef HLIB_UNALIGNED_READ_OK
+	char *scratch = NULL;
+	Size scratchlen = 0;
+#endif
+
+	desc = hlib_load_string_hash(fcinfo, hashname);
+
+	/* decide initvals, same rules as for scalar functions */
+	memset(iv, 0, sizeof(iv));
+	if (bits == 32) {
+		iv[0] = (PG_NARGS() >= 3) ? (uint64_t)PG_GETARG_INT32(2) : desc->initval;
+		restype = INT4OID;
+		elemsize = 4;
+	} else if (bits == 64) {
+		iv[0] = (PG_NARGS() >= 3) ? (uint64_t)PG_GETARG_INT64(2) : desc->initval;
+		if (PG_NARGS() >= 4)
+			iv[1] = PG_GETARG_INT64(3);
+		restype = INT8OID;
+		elemsize = 8;
+	} else {
+		if (PG_NARGS() >= 3)
+			iv[0] = PG_GETARG_INT64(2);
+		if (PG_NARGS() >= 4)
+			iv[1] = PG_GETARG_INT64(3);
+		restype = BYTEAOID;
+		elemsize = HASH128_ELEM_SIZE;
+	}
+
+	if (nitems == 0)
+		PG_RETURN_ARRAYTYPE_P(construct_empty_array(restype));
+
+	/* count non-null values */
+	if (bitmap) {
+		for (i = 0; i < nitems; i++) {
+			if (!(bitmap[i / 8] & (1 << (i % 8))))
+				nvalues--;
+		}
+		if (nvalues == nitems)
+			bitmap = NULL;
+	}
+
+	/* allocate result */
+	if (bitmap) {
+		dataoffset = ARR_OVERHEAD_WITHNULLS(ndim, nitems);
+		size = dataoffset + (Size)nvalues * elemsize;
+	} else {
+		dataoffset = 0;
+		size = ARR_OVERHEAD_NONULLS(ndim) + (Size)nvalues * elemsize;
+	}
+	res = palloc0(size);
+	SET_VARSIZE(res, size);
+	res->ndim = ndim;
+	res->dataoffset = dataoffset;
+	res->elemtype = restype;
+	memcpy(ARR_DIMS(res), ARR_DIMS(arr), ndim * sizeof(int));
+	memcpy(ARR_LBOUND(res), ARR_LBOUND(arr), ndim * sizeof(int));
+	if (bitmap)
+		memcpy(ARR_NULLBITMAP(res), bitmap, (nitems + 7) / 8);
+
+	/* hash elements */
+	src = ARR_DATA_PTR(arr);
+	dst = ARR_DATA_PTR(res);
+	bitmask = 1;
+	for (i = 0; i < nitems; i++) {
+		if (bitmap == NULL || (*bitmap & bitmask)) {
+			io[0] = iv[0];
+			io[1] = iv[1];
+			data = VARDATA_ANY(src);
+			len = VARSIZE_ANY_EXHDR(src);
+#ifndef HLIB_UNALIGNED_READ_OK
+			/* elements with short header are unaligned, hash aligned copy */
+			if (VARATT_IS_SHORT(src) && len > 0) {
+				if (len > scratchlen) {
+					if (scratch)
+						pfree(scratch);
+					scratchlen = len;
+					scratch = palloc(scratchlen);
+				}
+				memcpy(scratch, data, len);
+				data = scratch;
+			}
+#endif
+			desc->hash(data, len, io);
+
+			src = att_addlength_pointer(src, -1, src);
+			src = (char *) att_align_nominal(src, 'i');
+
+			if (bits == 32) {
+				int32 v = io[0];
+				memcpy(dst, &v, 4);
+			} else if (bits == 64) {
+				int64 v = io[0];
+				memcpy(dst, &v, 8);
+			} else {
+				SET_VARSIZE(dst, VARHDRSZ + 16);
+				io[0] = htole64(io[0]);
+				io[1] = htole64(io[1]);
+				memcpy(VARDATA(dst), io, 16);
+			}
+			dst += elemsize;
+		}
+		if (bitmap) {
+			bitmask <<= 1;
+			if (bitmask == 0x100) {
+				bitmap++;
+				bitmask = 1;
+			}
+		}
+	}
+
+#ifndef HLIB_UNALIGNED_READ_OK
+	if (scratch)
+		pfree(scratch);
+#endif
+	PG_FREE_IF_COPY(arr, 0);
+	PG_FREE_IF_COPY(hashname, 1);
+
+	PG_RETURN_ARRAYTYPE_P(res);
+}
+
+/* hash_string(bytea[], text [, int4]) returns int4[] */
+Datum
+pg_hash_string_array(PG_FUNCTION_ARGS)
+{
+	return hash_string_array(fcinfo, 32);
+}
+
+/* hash64_string(bytea[], text [, int8 [, int8]]) returns int8[] */
+Datum
+pg_hash64_string_array(PG_FUNCTION_ARGS)
+{
+	return hash_string_array(fcinfo, 64);
+}
+
+/* hash128_string(bytea[], text [, int8 [, int8]]) returns bytea[] */
+Datum
+pg_hash128_string_array(PG_FUNCTION_ARGS)
+{
+	return hash_string_array(fcinfo, 128);
+}
+
 /*
  * Integer hashing
  */
@@ -285,9 +592,7 @@ pg_hash_int32(PG_FUNCTION_ARGS)
 	text *hashname = PG_GETARG_TEXT_PP(1);
 	const struct Int32HashDesc *desc;
 
-	desc = find_int32_hash(VARDATA_ANY(hashname), VARSIZE_ANY_EXHDR(hashname));
-	if (desc == NULL)
-		err_nohash(hashname);
+	desc = hlib_load_int32_hash(fcinfo, hashname);
 
 	PG_FREE_IF_COPY(hashname, 1);
 
@@ -302,9 +607,7 @@ pg_hash_int32from64(PG_FUNCTION_ARGS)
 	text *hashname = PG_GETARG_TEXT_PP(1);
 	const struct Int32HashDesc *desc;
 
-	desc = find_int32_hash(VARDATA_ANY(hashname), VARSIZE_ANY_EXHDR(hashname));
-	if (desc == NULL)
-		err_nohash(hashname);
+	desc = hlib_load_int32_hash(fcinfo, hashname);
 	PG_FREE_IF_COPY(hashname, 1);
 
 	data = ((data >> 32) ^ data) & 0xFFFFFFFF;
@@ -319,11 +622,434 @@ pg_hash_int64(PG_FUNCTION_ARGS)
 	text *hashname = PG_GETARG_TEXT_PP(1);
 	const struct Int64HashDesc *desc;
 
-	desc = find_int64_hash(VARDATA_ANY(hashname), VARSIZE_ANY_EXHDR(hashname));
-	if (desc == NULL)
-		err_nohash(hashname);
+	desc = hlib_load_int64_hash(fcinfo, hashname);
 	PG_FREE_IF_COPY(hashname, 1);
 
 	PG_RETURN_INT64(desc->hash(data));
 }
 
+/*
+ * CRC combining.
+ *
+ * Gives CRC of concatenated data from CRCs of its parts,
+ * so parts can be hashed independently.
+ */
+
+/* crc32_combine(int4, int4, int8) returns int4 */
+Datum
+pg_crc32_combine(PG_FUNCTION_ARGS)
+{
+	int64 len2 = PG_GETARG_INT64(2);
+
+	if (len2 < 0)
+		elog(ERROR, "length must not be negative");
+	PG_RETURN_INT32(hlib_crc32_combine(PG_GETARG_INT32(0), PG_GETARG_INT32(1), len2));
+}
+
+/* crc32c_combine(int4, int4, int8) returns int4 */
+Datum
+pg_crc32c_combine(PG_FUNCTION_ARGS)
+{
+	int64 len2 = PG_GETARG_INT64(2);
+
+	if (len2 < 0)
+		elog(ERROR, "length must not be negative");
+	PG_RETURN_INT32(hlib_crc32c_combine(PG_GETARG_INT32(0), PG_GETARG_INT32(1), len2));
+}
+
+
+/*
+ * Per-algorithm entry points.
+ *
+ * These take no algorithm name, planner support function
+ * rewrites calls with constant name into them.
+ */
+
+static void
+hash_arg0(FunctionCallInfo fcinfo, hlib_str_hash_fn hash,
+	  const struct HashStreamOps *stream, uint64_t *io)
+{
+	hlib_hash_varlena(hash, stream, PG_GETARG_DATUM(0), io);
+}
+
+static bytea *
+make_hash128(uint64_t *io)
+{
+	bytea *res;
+
+	/* always output little-endian */
+	io[0] = htole64(io[0]);
+	io[1] = htole64(io[1]);
+
+	res = palloc(VARHDRSZ + 16);
+	SET_VARSIZE(res, VARHDRSZ + 16);
+	memcpy(VARDATA(res), io, 16);
+	return res;
+}
+
+#define STR_HASH_ENTRIES(algo, fn, stream, iv) \
+PG_FUNCTION_INFO_V1(pg_hash_ ## algo); \
+PG_FUNCTION_INFO_V1(pg_hash64_ ## algo); \
+PG_FUNCTION_INFO_V1(pg_hash128_ ## algo); \
+Datum pg_hash_ ## algo(PG_FUNCTION_ARGS); \
+Datum pg_hash64_ ## algo(PG_FUNCTION_ARGS); \
+Datum pg_hash128_ ## algo(PG_FUNCTION_ARGS); \
+Datum pg_hash_ ## algo(PG_FUNCTION_ARGS) \
+{ \
+	uint64_t io[MAX_IO_VALUES] = { iv, 0 }; \
+	hash_arg0(fcinfo, fn, stream, io); \
+	PG_RETURN_INT32(io[0]); \
+} \
+Datum pg_hash64_ ## algo(PG_FUNCTION_ARGS) \
+{ \
+	uint64_t io[MAX_IO_VALUES] = { iv, 0 }; \
+	hash_arg0(fcinfo, fn, stream, io); \
+	PG_RETURN_INT64(io[0]); \
+} \
+Datum pg_hash128_ ## algo(PG_FUNCTION_ARGS) \
+{ \
+	uint64_t io[MAX_IO_VALUES] = { 0, 0 }; \
+	hash_arg0(fcinfo, fn, stream, io); \
+	PG_RETURN_BYTEA_P(make_hash128(io)); \
+}
+
+#define INT32_HASH_ENTRIES(algo, fn) \
+PG_FUNCTION_INFO_V1(pg_hash_int32_ ## algo); \
+PG_FUNCTION_INFO_V1(pg_hash_int32from64_ ## algo); \
+Datum pg_hash_int32_ ## algo(PG_FUNCTION_ARGS); \
+Datum pg_hash_int32from64_ ## algo(PG_FUNCTION_ARGS); \
+Datum pg_hash_int32_ ## algo(PG_FUNCTION_ARGS) \
+{ \
+	PG_RETURN_INT32(fn(PG_GETARG_INT32(0))); \
+} \
+Datum pg_hash_int32from64_ ## algo(PG_FUNCTION_ARGS) \
+{ \
+	uint64_t data = PG_GETARG_INT64(0); \
+	data = ((data >> 32) ^ data) & 0xFFFFFFFF; \
+	PG_RETURN_INT32(fn(data)); \
+}
+
+#define INT64_HASH_ENTRIES(algo, fn) \
+PG_FUNCTION_INFO_V1(pg_hash_int64_ ## algo); \
+Datum pg_hash_int64_ ## algo(PG_FUNCTION_ARGS); \
+Datum pg_hash_int64_ ## algo(PG_FUNCTION_ARGS) \
+{ \
+	PG_RETURN_INT64(fn(PG_GETARG_INT64(0))); \
+}
+
+STR_HASH_ENTRIES(lookup2, hlib_lookup2_hash, NULL, 3923095)
+#ifdef WORDS_BIGENDIAN
+STR_HASH_ENTRIES(lookup3, hlib_lookup3_hashbig, NULL, 0)
+#else
+STR_HASH_ENTRIES(lookup3, hlib_lookup3_hashlittle, NULL, 0)
+#endif
+STR_HASH_ENTRIES(lookup3le, hlib_lookup3_hashlittle, NULL, 0)
+STR_HASH_ENTRIES(lookup3be, hlib_lookup3_hashbig, NULL, 0)
+STR_HASH_ENTRIES(siphash24, hlib_siphash24, &hlib_siphash24_stream, 0)
+STR_HASH_ENTRIES(siphash24_128, hlib_siphash24_128, NULL, 0)
+STR_HASH_ENTRIES(siphash13, hlib_siphash13, &hlib_siphash13_stream, 0)
+STR_HASH_ENTRIES(halfsiphash13, hlib_halfsiphash13, NULL, 0)
+STR_HASH_ENTRIES(murmur3, hlib_murmur3, &hlib_murmur3_stream, 0)
+STR_HASH_ENTRIES(murmur3_128, hlib_murmur3_128, NULL, 0)
+STR_HASH_ENTRIES(murmur3_x86_128, hlib_murmur3_x86_128, NULL, 0)
+STR_HASH_ENTRIES(city64, hlib_cityhash64, NULL, 0)
+STR_HASH_ENTRIES(city128, hlib_cityhash128, NULL, 0)
+STR_HASH_ENTRIES(citycrc128, hlib_citycrc128, NULL, 0)
+STR_HASH_ENTRIES(citycrc256, hlib_citycrc256_128, NULL, 0)
+STR_HASH_ENTRIES(spooky, hlib_spookyhash, &hlib_spookyhash_stream, 0)
+STR_HASH_ENTRIES(pgsql84, hlib_pgsql84, NULL, 0)
+STR_HASH_ENTRIES(md5, hlib_md5, &hlib_md5_stream, 0)
+STR_HASH_ENTRIES(crc32, hlib_crc32, &hlib_crc32_stream, 0)
+STR_HASH_ENTRIES(crc32c, hlib_crc32c, &hlib_crc32c_stream, 0)
+STR_HASH_ENTRIES(xxh64, hlib_xxh64, &hlib_xxh64_stream, 0)
+STR_HASH_ENTRIES(xxh3_64, hlib_xxh3_64, &hlib_xxh3_64_stream, 0)
+STR_HASH_ENTRIES(xxh3_128, hlib_xxh3_128, &hlib_xxh3_128_stream, 0)
+
+INT32_HASH_ENTRIES(wang32, hlib_wang32)
+INT32_HASH_ENTRIES(wang32mult, hlib_wang32mult)
+INT32_HASH_ENTRIES(jenkins, hlib_int32_jenkins)
+
+INT64_HASH_ENTRIES(wang64, hlib_int64_wang)
+INT64_HASH_ENTRIES(wang64to32, hlib_int64to32_wang)
+
+/*
+ * Hash operator class support.
+ *
+ * Function 1 is low 32 bits of function 2 with zero seed,
+ * function 2 is same as hash64_string(data, algo, seed) and
+ * hash_int8(data # seed, algo).
+ */
+
+#if PG_VERSION_NUM >= 120000
+static void
+check_collation(Oid collid)
+{
+	if (!OidIsValid(collid) || collid == DEFAULT_COLLATION_OID || collid == C_COLLATION_OID)
+		return;
+	if (!get_collation_isdeterministic(collid))
+		elog(ERROR, "nondeterministic collations are not supported by hashlib operator classes");
+}
+#else
+#define check_collation(collid)
+#endif
+
+#define STR_OPCLASS_ENTRIES(algo, fn, stream) \
+PG_FUNCTION_INFO_V1(pg_opclass_hash_ ## algo); \
+PG_FUNCTION_INFO_V1(pg_opclass_hash_extended_ ## algo); \
+Datum pg_opclass_hash_ ## algo(PG_FUNCTION_ARGS); \
+Datum pg_opclass_hash_extended_ ## algo(PG_FUNCTION_ARGS); \
+Datum pg_opclass_hash_ ## algo(PG_FUNCTION_ARGS) \
+{ \
+	uint64_t io[MAX_IO_VALUES] = { 0, 0 }; \
+	check_collation(PG_GET_COLLATION()); \
+	hash_arg0(fcinfo, fn, stream, io); \
+	PG_RETURN_INT32(io[0]); \
+} \
+Datum pg_opclass_hash_extended_ ## algo(PG_FUNCTION_ARGS) \
+{ \
+	uint64_t io[MAX_IO_VALUES] = { PG_GETARG_INT64(1), 0 }; \
+	check_collation(PG_GET_COLLATION()); \
+	hash_arg0(fcinfo, fn, stream, io); \
+	PG_RETURN_INT64(io[0]); \
+}
+
+#define INT64_OPCLASS_ENTRIES(algo, fn) \
+PG_FUNCTION_INFO_V1(pg_opclass_hash_int64_ ## algo); \
+PG_FUNCTION_INFO_V1(pg_opclass_hash_extended_int64_ ## algo); \
+Datum pg_opclass_hash_int64_ ## algo(PG_FUNCTION_ARGS); \
+Datum pg_opclass_hash_extended_int64_ ## algo(PG_FUNCTION_ARGS); \
+Datum pg_opclass_hash_int64_ ## algo(PG_FUNCTION_ARGS) \
+{ \
+	PG_RETURN_INT32(fn(PG_GETARG_INT64(0))); \
+} \
+Datum pg_opclass_hash_extended_int64_ ## algo(PG_FUNCTION_ARGS) \
+{ \
+	PG_RETURN_INT64(fn(PG_GETARG_INT64(0) ^ PG_GETARG_INT64(1))); \
+}
+
+STR_OPCLASS_ENTRIES(city64, hlib_cityhash64, NULL)
+/* x64 128-bit variant, so extended function takes whole seed and gives 64 bits */
+STR_OPCLASS_ENTRIES(murmur3, hlib_murmur3_128, NULL)
+
+INT64_OPCLASS_ENTRIES(wang64, hlib_int64_wang)
+
+/*
+ * Planner support (PG12+).
+ *
+ * Rewrites calls with constant algorithm name into per-algorithm
+ * entry points and gives cost estimates based on algorithm.
+ */
+
+#if PG_VERSION_NUM >= 120000
+
+enum HashCallKind {
+	CALL_UNKNOWN = 0,
+	CALL_STR32,
+	CALL_STR64,
+	CALL_STR128,
+	CALL_INT32,
+	CALL_INT32FROM64,
+	CALL_INT64,
+};
+
+/* detect which dispatcher is called from argument and result types */
+static enum HashCallKind
+hash_call_kind(List *args, Oid rettype)
+{
+	Oid argtype;
+
+	if (list_length(args) < 2)
+		return CALL_UNKNOWN;
+	argtype = exprType(linitial(args));
+
+	if (argtype == TEXTOID || argtype == BYTEAOID) {
+		if (rettype == INT4OID)
+			return CALL_STR32;
+		if (rettype == INT8OID)
+			return CALL_STR64;
+		if (rettype == BYTEAOID)
+			return CALL_STR128;
+	} else if (argtype == INT4OID && rettype == INT4OID) {
+		return CALL_INT32;
+	} else if (argtype == INT8OID && rettype == INT4OID) {
+		return CALL_INT32FROM64;
+	} else if (argtype == INT8OID && rettype == INT8OID) {
+		return CALL_INT64;
+	}
+	return CALL_UNKNOWN;
+}
+
+/* return algorithm name from constant node, or NULL */
+static text *
+const_hash_name(Node *node)
+{
+	Const *c;
+
+	if (!IsA(node, Const))
+		return NULL;
+	c = (Const *) node;
+	if (c->constisnull || c->consttype != TEXTOID)
+		return NULL;
+	return DatumGetTextPP(c->constvalue);
+}
+
+static Node *
+simplify_hash_call(SupportRequestSimplify *req)
+{
+	FuncExpr *fcall = req->fcall;
+	enum HashCallKind kind;
+	const char *prefix;
+	const char *algo;
+	text *hashname;
+	Node *arg;
+	Oid argtype;
+	Oid funcoid;
+	char *nspname;
+	char fname[NAMEDATALEN];
+	List *qname;
+	FuncExpr *res;
+
+	/* only calls without initval */
+	if (list_length(fcall->args) != 2)
+		return NULL;
+
+	kind = hash_call_kind(fcall->args, fcall->funcresulttype);
+	hashname = const_hash_name(lsecond(fcall->args));
+	if (kind == CALL_UNKNOWN || hashname == NULL)
+		return NULL;
+
+	arg = linitial(fcall->args);
+	argtype = exprType(arg);
+
+	switch (kind) {
+	case CALL_STR32:
+	case CALL_STR64:
+	case CALL_STR128:
+		{
+			const struct StrHashDesc *desc;
+			desc = hlib_find_string_hash(VARDATA_ANY(hashname), VARSIZE_ANY_EXHDR(hashname));
+			if (desc == NULL)
+				return NULL;
+			algo = desc->name;
+		}
+		if (kind == CALL_STR32)
+			prefix = "hashlib_";
+		else if (kind == CALL_STR64)
+			prefix = "hashlib64_";
+		else
+			prefix = "hashlib128_";
+
+		/* entry points take bytea, text has same representation */
+		if (argtype == TEXTOID)
+			arg = (Node *) makeRelabelType((Expr *) arg, BYTEAOID, -1, InvalidOid,
+						       COERCE_IMPLICIT_CAST);
+		argtype = BYTEAOID;
+		break;
+	case CALL_INT32:
+	case CALL_INT32FROM64:
+		{
+			const struct Int32HashDesc *desc;
+			desc = hlib_find_int32_hash(VARDATA_ANY(hashname), VARSIZE_ANY_EXHDR(hashname));
+			if (desc == NULL)
+				return NULL;
+			algo = desc->name;
+		}
+		prefix = "hashlib_int4_";
+		break;
+	case CALL_INT64:
+		{
+			const struct Int64HashDesc *desc;
+			desc = hlib_find_int64_hash(VARDATA_ANY(hashname), VARSIZE_ANY_EXHDR(hashname));
+			if (desc == NULL)
+				return NULL;
+			algo = desc->name;
+		}
+		prefix = "hashlib_int8_";
+		break;
+	default:
+		return NULL;
+	}
+
+	/* entry point lives in same schema as dispatcher */
+	snprintf(fname, sizeof(fname), "%s%s", prefix, algo);
+	nspname = get_namespace_name(get_func_namespace(fcall->funcid));
+	if (nspname == NULL)
+		return NULL;
+	qname = list_make2(makeString(nspname), makeString(pstrdup(fname)));
+	funcoid = LookupFuncName(qname, 1, &argtype, true);
+	if (!OidIsValid(funcoid))
+		return NULL;
+
+	res = makeFuncExpr(funcoid, fcall->funcresulttype, list_make1(arg),
+			   fcall->funccollid, fcall->inputcollid, COERCE_EXPLICIT_CALL);
+	res->location = fcall->location;
+	return (Node *) res;
+}
+
+/* estimate width of data argument in bytes */
+static double
+data_width(Node *arg)
+{
+	if (IsA(arg, Const)) {
+		Const *c = (Const *) arg;
+		if (c->constisnull)
+			return 0;
+		return VARSIZE_ANY_EXHDR(DatumGetPointer(c->constvalue));
+	}
+	return get_typavgwidth(exprType(arg), exprTypmod(arg));
+}
+
+static Node *
+estimate_hash_cost(SupportRequestCost *req)
+{
+	FuncExpr *fcall;
+	const struct StrHashDesc *desc;
+	text *hashname;
+	double blocks;
+
+	if (req->node == NULL || !IsA(req->node, FuncExpr))
+		return NULL;
+	fcall = (FuncExpr *) req->node;
+
+	/* integer hashes are all cheap, default cost is fine */
+	switch (hash_call_kind(fcall->args, fcall->funcresulttype)) {
+	case CALL_STR32:
+	case CALL_STR64:
+	case CALL_STR128:
+		break;
+	default:
+		return NULL;
+	}
+
+	hashname = const_hash_name(lsecond(fcall->args));
+	if (hashname == NULL)
+		return NULL;
+	desc = hlib_find_string_hash(VARDATA_ANY(hashname), VARSIZE_ANY_EXHDR(hashname));
+	if (desc == NULL)
+		return NULL;
+
+	blocks = ceil(data_width(linitial(fcall->args)) / 64.0);
+	if (blocks < 1)
+		blocks = 1;
+
+	req->startup = 0;
+	req->per_tuple = (1 + desc->cost * blocks) * cpu_operator_cost;
+	return (Node *) req;
+}
+
+#endif
+
+/* hashlib_support(internal) returns internal */
+Datum
+pg_hashlib_support(PG_FUNCTION_ARGS)
+{
+#if PG_VERSION_NUM >= 120000
+	Node *rawreq = (Node *) PG_GETARG_POINTER(0);
+
+	if (IsA(rawreq, SupportRequestSimplify))
+		PG_RETURN_POINTER(simplify_hash_call((SupportRequestSimplify *) rawreq));
+	if (IsA(rawreq, SupportRequestCost))
+		PG_RETURN_POINTER(estimate_hash_cost((SupportRequestCost *) rawreq));
+#endif
+	PG_RETURN_POINTER(NULL);
+}
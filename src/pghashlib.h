@@ -3,6 +3,7 @@
 
 #include <postgres.h>
 #include <fmgr.h>
+#include <lib/stringinfo.h>
 
 #ifdef HAVE_STDINT_H
 #include <stdint.h>
@@ -33,24 +34,135 @@
 /* how many values in io array will be used, max */
 #define MAX_IO_VALUES 2
 
+/* output values of 256-bit hashes, they have separate entry point */
+#define HASH256_VALUES 4
+
 /* hash function signatures */
 typedef void     (*hlib_str_hash_fn)(const void *data, size_t len, uint64_t *io);
 typedef uint32_t (*hlib_int32_hash_fn)(uint32_t data);
 typedef uint64_t (*hlib_int64_hash_fn)(uint64_t data);
+typedef void     (*hlib_multi_hash_fn)(const void *data, size_t len, const uint64_t *seeds,
+				   uint64_t *out, int nseeds);
+
+/*
+ * Incremental hashing.
+ *
+ * Caller fills io with initvals, same way as for one-shot hash, and
+ * gives it to init() and later to final().  Feeding data in pieces
+ * via update() gives same result as one-shot hash over whole data.
+ */
+struct HashStreamOps {
+	size_t state_size;
+	void (*init)(void *state, const uint64_t *io);
+	void (*update)(void *state, const void *data, size_t len);
+	void (*final)(void *state, uint64_t *io);
+};
+
+/* algorithm descriptors */
+#define HASHNAMELEN 16
+
+struct StrHashDesc {
+	int namelen;
+	const char name[HASHNAMELEN];
+	hlib_str_hash_fn hash;
+	int bits;		/* max output bits */
+	uint64_t initval;
+	float cost;		/* per 64 bytes, in cpu_operator_cost units */
+	const struct HashStreamOps *stream;	/* NULL if not supported */
+	hlib_str_hash_fn hash256;	/* HASH256_VALUES of output, NULL if not supported */
+};
+
+struct Int32HashDesc {
+	int namelen;
+	const char name[HASHNAMELEN];
+	hlib_int32_hash_fn hash;
+};
+
+struct Int64HashDesc {
+	int namelen;
+	const char name[HASHNAMELEN];
+	hlib_int64_hash_fn hash;
+	int bits;
+};
+
+const struct StrHashDesc *hlib_find_string_hash(const char *name, unsigned nlen);
+const struct Int32HashDesc *hlib_find_int32_hash(const char *name, unsigned nlen);
+const struct Int64HashDesc *hlib_find_int64_hash(const char *name, unsigned nlen);
+
+/* lookup with per-call-site cache in fn_extra, error if not found */
+const struct StrHashDesc *hlib_load_string_hash(FunctionCallInfo fcinfo, text *hashname);
+const struct Int32HashDesc *hlib_load_int32_hash(FunctionCallInfo fcinfo, text *hashname);
+const struct Int64HashDesc *hlib_load_int64_hash(FunctionCallInfo fcinfo, text *hashname);
+
+void hlib_hash_varlena(hlib_str_hash_fn hash, const struct HashStreamOps *stream,
+		       Datum value, uint64_t *io);
+
+/* streaming of big toasted values, false if value should be detoasted normally */
+#if PG_VERSION_NUM >= 90600
+bool hlib_stream_toasted(const struct HashStreamOps *ops, void *state, Datum value);
+bool hlib_hash_toasted(const struct HashStreamOps *ops, Datum value, uint64_t *io);
+#else
+#define hlib_stream_toasted(ops, state, value) (false)
+#define hlib_hash_toasted(ops, value, io) (false)
+#endif
+
+/* helpers for aggregates and sketch types */
+#if PG_VERSION_NUM >= 90600
+MemoryContext hlib_agg_context(FunctionCallInfo fcinfo, const char *fname);
+void hlib_put_le32(StringInfo buf, uint32 val);
+void hlib_put_le64(StringInfo buf, uint64 val);
+uint32 hlib_get_le32(StringInfo buf);
+uint64 hlib_get_le64(StringInfo buf);
+bytea *hlib_hex_in(const char *str, const char *what);
+char *hlib_hex_out(const char *data, size_t len);
+#endif
 
 /* string hashes */
 void hlib_crc32(const void *data, size_t len, uint64_t *io);
+void hlib_crc32c(const void *data, size_t len, uint64_t *io);
 void hlib_lookup2_hash(const void *data, size_t len, uint64_t *io);
 void hlib_lookup3_hashlittle(const void *data, size_t len, uint64_t *io);
 void hlib_lookup3_hashbig(const void *data, size_t len, uint64_t *io);
 void hlib_pgsql84(const void *data, size_t len, uint64_t *io);
 void hlib_murmur3(const void *data, size_t len, uint64_t *io);
+void hlib_murmur3_128(const void *data, size_t len, uint64_t *io);
+void hlib_murmur3_x86_128(const void *data, size_t len, uint64_t *io);
 
 void hlib_cityhash64(const void *data, size_t len, uint64_t *io);
 void hlib_cityhash128(const void *data, size_t len, uint64_t *io);
+void hlib_citycrc128(const void *data, size_t len, uint64_t *io);
+void hlib_citycrc256(const void *data, size_t len, uint64_t *out);
+void hlib_citycrc256_128(const void *data, size_t len, uint64_t *io);
 void hlib_spookyhash(const void *data, size_t len, uint64_t *io);
 void hlib_md5(const void *data, size_t len, uint64_t *io);
 void hlib_siphash24(const void *data, size_t len, uint64_t *io);
+void hlib_siphash24_128(const void *data, size_t len, uint64_t *io);
+void hlib_siphash13(const void *data, size_t len, uint64_t *io);
+void hlib_halfsiphash13(const void *data, size_t len, uint64_t *io);
+void hlib_xxh64(const void *data, size_t len, uint64_t *io);
+void hlib_xxh3_64(const void *data, size_t len, uint64_t *io);
+void hlib_xxh3_128(const void *data, size_t len, uint64_t *io);
+
+/* string hashes with several seeds in one pass */
+void hlib_murmur3_multi(const void *data, size_t len, const uint64_t *seeds, uint64_t *out, int nseeds);
+void hlib_cityhash64_multi(const void *data, size_t len, const uint64_t *seeds, uint64_t *out, int nseeds);
+
+/* combine CRCs of adjacent chunks, crc2 is over len2 bytes */
+uint32_t hlib_crc_combine(uint32_t poly, uint32_t crc1, uint32_t crc2, uint64_t len2);
+uint32_t hlib_crc32_combine(uint32_t crc1, uint32_t crc2, uint64_t len2);
+uint32_t hlib_crc32c_combine(uint32_t crc1, uint32_t crc2, uint64_t len2);
+
+/* incremental versions of string hashes */
+extern const struct HashStreamOps hlib_crc32_stream;
+extern const struct HashStreamOps hlib_crc32c_stream;
+extern const struct HashStreamOps hlib_murmur3_stream;
+extern const struct HashStreamOps hlib_spookyhash_stream;
+extern const struct HashStreamOps hlib_md5_stream;
+extern const struct HashStreamOps hlib_siphash24_stream;
+extern const struct HashStreamOps hlib_siphash13_stream;
+extern const struct HashStreamOps hlib_xxh64_stream;
+extern const struct HashStreamOps hlib_xxh3_64_stream;
+extern const struct HashStreamOps hlib_xxh3_128_stream;
 
 /* integer hashes */
 uint32_t hlib_int32_jenkins(uint32_t data);
@@ -64,9 +176,102 @@ uint64_t hlib_int64to32_wang(uint64_t data);
 Datum pg_hash_string(PG_FUNCTION_ARGS);
 Datum pg_hash64_string(PG_FUNCTION_ARGS);
 Datum pg_hash128_string(PG_FUNCTION_ARGS);
+Datum pg_hash_string_array(PG_FUNCTION_ARGS);
+Datum pg_hash64_string_array(PG_FUNCTION_ARGS);
+Datum pg_hash128_string_array(PG_FUNCTION_ARGS);
 Datum pg_hash_int32(PG_FUNCTION_ARGS);
 Datum pg_hash_int32from64(PG_FUNCTION_ARGS);
 Datum pg_hash_int64(PG_FUNCTION_ARGS);
+Datum pg_hashlib_support(PG_FUNCTION_ARGS);
+
+/* aggregates */
+Datum pg_fingerprint_transfn(PG_FUNCTION_ARGS);
+Datum pg_fingerprint_combine(PG_FUNCTION_ARGS);
+Datum pg_fingerprint_serial(PG_FUNCTION_ARGS);
+Datum pg_fingerprint_deserial(PG_FUNCTION_ARGS);
+Datum pg_fingerprint_final(PG_FUNCTION_ARGS);
+Datum pg_hash_agg_transfn(PG_FUNCTION_ARGS);
+Datum pg_hash_agg_final32(PG_FUNCTION_ARGS);
+Datum pg_hash_agg_final64(PG_FUNCTION_ARGS);
+Datum pg_hash_agg_final128(PG_FUNCTION_ARGS);
+
+/* typed values */
+Datum pg_hash_any(PG_FUNCTION_ARGS);
+Datum pg_hash64_any(PG_FUNCTION_ARGS);
+Datum pg_hash128_any(PG_FUNCTION_ARGS);
+
+/* bloom filter */
+Datum pg_bloom_in(PG_FUNCTION_ARGS);
+Datum pg_bloom_out(PG_FUNCTION_ARGS);
+Datum pg_bloom_recv(PG_FUNCTION_ARGS);
+Datum pg_bloom_send(PG_FUNCTION_ARGS);
+Datum pg_bloom_agg_transfn(PG_FUNCTION_ARGS);
+Datum pg_bloom_union(PG_FUNCTION_ARGS);
+Datum pg_bloom_contains(PG_FUNCTION_ARGS);
+
+/* hyperloglog */
+Datum pg_hll_in(PG_FUNCTION_ARGS);
+Datum pg_hll_out(PG_FUNCTION_ARGS);
+Datum pg_hll_recv(PG_FUNCTION_ARGS);
+Datum pg_hll_send(PG_FUNCTION_ARGS);
+Datum pg_hll_add_transfn(PG_FUNCTION_ARGS);
+Datum pg_hll_union_transfn(PG_FUNCTION_ARGS);
+Datum pg_hll_combine(PG_FUNCTION_ARGS);
+Datum pg_hll_serial(PG_FUNCTION_ARGS);
+Datum pg_hll_deserial(PG_FUNCTION_ARGS);
+Datum pg_hll_final(PG_FUNCTION_ARGS);
+Datum pg_hll_union(PG_FUNCTION_ARGS);
+Datum pg_hll_cardinality(PG_FUNCTION_ARGS);
+
+/* minhash */
+Datum pg_minhash_transfn(PG_FUNCTION_ARGS);
+Datum pg_minhash_combine(PG_FUNCTION_ARGS);
+Datum pg_minhash_serial(PG_FUNCTION_ARGS);
+Datum pg_minhash_deserial(PG_FUNCTION_ARGS);
+Datum pg_minhash_final(PG_FUNCTION_ARGS);
+Datum pg_minhash_array(PG_FUNCTION_ARGS);
+Datum pg_minhash_similarity(PG_FUNCTION_ARGS);
+Datum pg_minhash_bands(PG_FUNCTION_ARGS);
+
+/* count-min sketch */
+Datum pg_cms_in(PG_FUNCTION_ARGS);
+Datum pg_cms_out(PG_FUNCTION_ARGS);
+Datum pg_cms_recv(PG_FUNCTION_ARGS);
+Datum pg_cms_send(PG_FUNCTION_ARGS);
+Datum pg_cms_add_transfn(PG_FUNCTION_ARGS);
+Datum pg_cms_combine(PG_FUNCTION_ARGS);
+Datum pg_cms_serial(PG_FUNCTION_ARGS);
+Datum pg_cms_deserial(PG_FUNCTION_ARGS);
+Datum pg_cms_final(PG_FUNCTION_ARGS);
+Datum pg_cms_union(PG_FUNCTION_ARGS);
+Datum pg_cms_estimate(PG_FUNCTION_ARGS);
+Datum pg_cms_top(PG_FUNCTION_ARGS);
+
+/* shard routing */
+Datum pg_jump_hash(PG_FUNCTION_ARGS);
+Datum pg_jump_hash_string(PG_FUNCTION_ARGS);
+Datum pg_jump_hash_moves(PG_FUNCTION_ARGS);
+Datum pg_rendezvous_pick(PG_FUNCTION_ARGS);
+Datum pg_rendezvous_top(PG_FUNCTION_ARGS);
+Datum pg_hash_bucket(PG_FUNCTION_ARGS);
+Datum pg_hash_int_bucket(PG_FUNCTION_ARGS);
+
+/* consistent hash ring */
+Datum pg_ring_in(PG_FUNCTION_ARGS);
+Datum pg_ring_out(PG_FUNCTION_ARGS);
+Datum pg_ring_recv(PG_FUNCTION_ARGS);
+Datum pg_ring_send(PG_FUNCTION_ARGS);
+Datum pg_ring_build(PG_FUNCTION_ARGS);
+Datum pg_ring_lookup(PG_FUNCTION_ARGS);
+Datum pg_ring_assign(PG_FUNCTION_ARGS);
+
+/* tablesample method */
+Datum pg_hashlib_tsm_handler(PG_FUNCTION_ARGS);
+
+/* streaming */
+Datum pg_hash_lo(PG_FUNCTION_ARGS);
+Datum pg_hash64_lo(PG_FUNCTION_ARGS);
+Datum pg_hash128_lo(PG_FUNCTION_ARGS);
 
 #endif
 
@@ -0,0 +1,514 @@
+/*
+ * HyperLogLog distinct-count sketch.
+ *
+ * Value is hashed with hash64_string(value, algo), for 32-bit
+ * algorithms only low 32 bits are used.  Top `precision` bits of hash
+ * select register, register keeps max position of first 1-bit in
+ * the rest.
+ *
+ * Small sketches keep (index, rank) pairs, when those would take more
+ * space than registers, sketch is switched to dense form.
+ *
+ * Binary format (send/recv, text I/O is same in hex):
+ *
+ *   byte 0       version, 1
+ *   byte 1       format, 1 - sparse, 2 - dense
+ *   byte 2       precision
+ *   byte 3       hash bits, 32 or 64
+ *   bytes 4-7    number of sparse entries, uint32 little-endian
+ *   bytes 8-23   algorithm name, zero-padded
+ *   bytes 24-    sparse: entries as uint32 little-endian (index << 8 | rank),
+ *                sorted by index; dense: one byte per register
+ */
+
+#include "pghashlib.h"
+
+#if PG_VERSION_NUM >= 90600
+
+#include <math.h>
+
+#include "libpq/pqformat.h"
+#include "utils/builtins.h"
+
+#define HLL_VERSION		1
+#define HLL_SPARSE		1
+#define HLL_DENSE		2
+#define HLL_ALGO_LEN		16
+#define HLL_HDRSZ		24
+#define HLL_MIN_PRECISION	4
+#define HLL_MAX_PRECISION	18
+
+#define HLL_ENTRY(idx, rank)	(((uint32) (idx) << 8) | (rank))
+#define HLL_ENTRY_INDEX(e)	((e) >> 8)
+#define HLL_ENTRY_RANK(e)	((e) & 0xFF)
+
+struct HllState {
+	const struct StrHashDesc *desc;
+	int precision;
+	int hashbits;
+	uint8 *regs;		/* dense registers, NULL while sparse */
+	uint32 *sparse;		/* unsorted entries */
+	int nsparse;
+	int maxsparse;
+};
+
+#define HLL_NREGS(st)		(1 << (st)->precision)
+
+PG_FUNCTION_INFO_V1(pg_hll_in);
+PG_FUNCTION_INFO_V1(pg_hll_out);
+PG_FUNCTION_INFO_V1(pg_hll_recv);
+PG_FUNCTION_INFO_V1(pg_hll_send);
+PG_FUNCTION_INFO_V1(pg_hll_add_transfn);
+PG_FUNCTION_INFO_V1(pg_hll_union_transfn);
+PG_FUNCTION_INFO_V1(pg_hll_combine);
+PG_FUNCTION_INFO_V1(pg_hll_serial);
+PG_FUNCTION_INFO_V1(pg_hll_deserial);
+PG_FUNCTION_INFO_V1(pg_hll_final);
+PG_FUNCTION_INFO_V1(pg_hll_union);
+PG_FUNCTION_INFO_V1(pg_hll_cardinality);
+
+/*
+ * State handling.
+ */
+
+static struct HllState *
+hll_create(MemoryContext mcxt, const struct StrHashDesc *desc, int precision)
+{
+	struct HllState *st;
+
+	if (precision < HLL_MIN_PRECISION || precision > HLL_MAX_PRECISION)
+		elog(ERROR, "hll precision must be between %d and %d",
+		     HLL_MIN_PRECISION, HLL_MAX_PRECISION);
+
+	st = MemoryContextAllocZero(mcxt, sizeof(*st));
+	st->desc = desc;
+	st->precision = precision;
+	st->hashbits = desc->bits >= 64 ? 64 : 32;
+
+	/* sparse form is used while it is smaller than registers */
+	st->maxsparse = HLL_NREGS(st) / 4;
+	st->sparse = MemoryContextAlloc(mcxt, st->maxsparse * sizeof(uint32));
+	return st;
+}
+
+static void
+hll_to_dense(struct HllState *st, MemoryContext mcxt)
+{
+	int i, idx, rank;
+
+	st->regs = MemoryContextAllocZero(mcxt, HLL_NREGS(st));
+	for (i = 0; i < st->nsparse; i++) {
+		idx = HLL_ENTRY_INDEX(st->sparse[i]);
+		rank = HLL_ENTRY_RANK(st->sparse[i]);
+		if (st->regs[idx] < rank)
+			st->regs[idx] = rank;
+	}
+	pfree(st->sparse);
+	st->sparse = NULL;
+	st->nsparse = 0;
+}
+
+static int
+cmp_entry(const void *a, const void *b)
+{
+	uint32 e1 = *(const uint32 *) a;
+	uint32 e2 = *(const uint32 *) b;
+
+	return (e1 < e2) ? -1 : (e1 > e2) ? 1 : 0;
+}
+
+/* sort and keep max rank for each index */
+static void
+hll_compact(struct HllState *st)
+{
+	int i, n = 0;
+
+	qsort(st->sparse, st->nsparse, sizeof(uint32), cmp_entry);
+	for (i = 0; i < st->nsparse; i++) {
+		/* sorted by index, then rank, so last one wins */
+		if (n > 0 && HLL_ENTRY_INDEX(st->sparse[n - 1]) == HLL_ENTRY_INDEX(st->sparse[i]))
+			n--;
+		st->sparse[n++] = st->sparse[i];
+	}
+	st->nsparse = n;
+}
+
+static void
+hll_set(struct HllState *st, MemoryContext mcxt, uint32 idx, int rank)
+{
+	if (st->regs) {
+		if (st->regs[idx] < rank)
+			st->regs[idx] = rank;
+		return;
+	}
+
+	if (st->nsparse >= st->maxsparse) {
+		hll_compact(st);
+		/* avoid compacting too often */
+		if (st->nsparse > st->maxsparse / 2) {
+			hll_to_dense(st, mcxt);
+			st->regs[idx] = Max(st->regs[idx], rank);
+			return;
+		}
+	}
+	st->sparse[st->nsparse++] = HLL_ENTRY(idx, rank);
+}
+
+static void
+hll_add_hash(struct HllState *st, MemoryContext mcxt, uint64_t hash)
+{
+	int rest = st->hashbits - st->precision;
+	uint64_t topbit = (uint64_t) 1 << (rest - 1);
+	uint64_t w;
+	uint32 idx;
+	int rank = 1;
+
+	if (st->hashbits == 32)
+		hash &= 0xFFFFFFFF;
+	idx = hash >> rest;
+	w = hash & ((topbit << 1) - 1);
+
+	/* position of first 1-bit, rest + 1 if none */
+	while (rank <= rest && !(w & topbit)) {
+		w <<= 1;
+		rank++;
+	}
+	hll_set(st, mcxt, idx, rank);
+}
+
+static void
+hll_merge(struct HllState *dst, MemoryContext mcxt, struct HllState *src)
+{
+	int i;
+
+	if (dst->desc != src->desc || dst->precision != src->precision)
+		elog(ERROR, "cannot combine hll sketches with different parameters");
+
+	if (src->regs) {
+		if (!dst->regs)
+			hll_to_dense(dst, mcxt);
+		for (i = 0; i < HLL_NREGS(dst); i++) {
+			if (dst->regs[i] < src->regs[i])
+				dst->regs[i] = src->regs[i];
+		}
+	} else {
+		for (i = 0; i < src->nsparse; i++)
+			hll_set(dst, mcxt, HLL_ENTRY_INDEX(src->sparse[i]), HLL_ENTRY_RANK(src->sparse[i]));
+	}
+}
+
+/*
+ * Binary format.
+ */
+
+static bytea *
+hll_serialize(struct HllState *st)
+{
+	StringInfoData buf;
+	char algo[HLL_ALGO_LEN];
+	int i;
+
+	if (!st->regs)
+		hll_compact(st);
+
+	memset(algo, 0, sizeof(algo));
+	memcpy(algo, st->desc->name, st->desc->namelen);
+
+	pq_begintypsend(&buf);
+	pq_sendbyte(&buf, HLL_VERSION);
+	pq_sendbyte(&buf, st->regs ? HLL_DENSE : HLL_SPARSE);
+	pq_sendbyte(&buf, st->precision);
+	pq_sendbyte(&buf, st->hashbits);
+	hlib_put_le32(&buf, st->nsparse);
+	pq_sendbytes(&buf, algo, HLL_ALGO_LEN);
+	if (st->regs) {
+		pq_sendbytes(&buf, (char *) st->regs, HLL_NREGS(st));
+	} else {
+		for (i = 0; i < st->nsparse; i++)
+			hlib_put_le32(&buf, st->sparse[i]);
+	}
+	return pq_endtypsend(&buf);
+}
+
+static struct HllState *
+hll_deserialize(MemoryContext mcxt, const char *data, int len)
+{
+	const struct StrHashDesc *desc;
+	struct HllState *st;
+	StringInfoData buf;
+	int format, precision, hashbits, nsparse, i;
+	uint32 e;
+
+	buf.data = (char *) data;
+	buf.len = len;
+	buf.maxlen = len;
+	buf.cursor = 0;
+
+	if (len < HLL_HDRSZ || pq_getmsgbyte(&buf) != HLL_VERSION)
+		elog(ERROR, "invalid hll sketch: unsupported version");
+	format = pq_getmsgbyte(&buf);
+	precision = pq_getmsgbyte(&buf);
+	hashbits = pq_getmsgbyte(&buf);
+	nsparse = hlib_get_le32(&buf);
+	desc = hlib_find_string_hash(buf.data + buf.cursor, strnlen(buf.data + buf.cursor, HLL_ALGO_LEN));
+	if (desc == NULL)
+		elog(ERROR, "invalid hll sketch: unknown hash");
+	buf.cursor += HLL_ALGO_LEN;
+
+	st = hll_create(mcxt, desc, precision);
+	if (hashbits != st->hashbits)
+		elog(ERROR, "invalid hll sketch: bad hash bits");
+
+	if (format == HLL_DENSE) {
+		if (nsparse != 0 || buf.len - buf.cursor != HLL_NREGS(st))
+			elog(ERROR, "invalid hll sketch: bad size");
+		hll_to_dense(st, mcxt);
+		pq_copymsgbytes(&buf, (char *) st->regs, HLL_NREGS(st));
+		for (i = 0; i < HLL_NREGS(st); i++) {
+			if (st->regs[i] > hashbits - precision + 1)
+				elog(ERROR, "invalid hll sketch: bad register");
+		}
+	} else if (format == HLL_SPARSE) {
+		if (nsparse < 0 || nsparse > st->maxsparse || buf.len - buf.cursor != nsparse * 4)
+			elog(ERROR, "invalid hll sketch: bad size");
+		for (i = 0; i < nsparse; i++) {
+			e = hlib_get_le32(&buf);
+			if (HLL_ENTRY_INDEX(e) >= HLL_NREGS(st) || HLL_ENTRY_RANK(e) < 1
+			    || HLL_ENTRY_RANK(e) > hashbits - precision + 1)
+				elog(ERROR, "invalid hll sketch: bad entry");
+			if (i > 0 && HLL_ENTRY_INDEX(e) <= HLL_ENTRY_INDEX(st->sparse[i - 1]))
+				elog(ERROR, "invalid hll sketch: entries not sorted");
+			st->sparse[i] = e;
+		}
+		st->nsparse = nsparse;
+	} else {
+		elog(ERROR, "invalid hll sketch: unknown format");
+	}
+	pq_getmsgend(&buf);
+	return st;
+}
+
+static struct HllState *
+hll_from_datum(MemoryContext mcxt, Datum value)
+{
+	bytea *data = DatumGetByteaPP(value);
+
+	return hll_deserialize(mcxt, VARDATA_ANY(data), VARSIZE_ANY_EXHDR(data));
+}
+
+#define PG_GETARG_HLL(n, mcxt) hll_from_datum(mcxt, PG_GETARG_DATUM(n))
+
+/*
+ * Type I/O.
+ */
+
+/* hll_in(cstring) returns hll */
+Datum
+pg_hll_in(PG_FUNCTION_ARGS)
+{
+	const char *str = PG_GETARG_CSTRING(0);
+	bytea *res;
+
+	res = hlib_hex_in(str, "hll sketch");
+	hll_deserialize(CurrentMemoryContext, VARDATA(res), VARSIZE(res) - VARHDRSZ);
+	PG_RETURN_BYTEA_P(res);
+}
+
+/* hll_out(hll) returns cstring */
+Datum
+pg_hll_out(PG_FUNCTION_ARGS)
+{
+	bytea *data = PG_GETARG_BYTEA_PP(0);
+
+	PG_RETURN_CSTRING(hlib_hex_out(VARDATA_ANY(data), VARSIZE_ANY_EXHDR(data)));
+}
+
+/* hll_recv(internal) returns hll */
+Datum
+pg_hll_recv(PG_FUNCTION_ARGS)
+{
+	StringInfo buf = (StringInfo) PG_GETARG_POINTER(0);
+	int len = buf->len - buf->cursor;
+	bytea *res;
+
+	res = palloc(VARHDRSZ + len);
+	SET_VARSIZE(res, VARHDRSZ + len);
+	pq_copymsgbytes(buf, VARDATA(res), len);
+	hll_deserialize(CurrentMemoryContext, VARDATA(res), len);
+	PG_RETURN_BYTEA_P(res);
+}
+
+/* hll_send(hll) returns bytea */
+Datum
+pg_hll_send(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_BYTEA_P(PG_GETARG_BYTEA_P(0));
+}
+
+/*
+ * Aggregates.
+ */
+
+/* hll_add_transfn(internal, bytea, text, int4) returns internal */
+Datum
+pg_hll_add_transfn(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggctx = hlib_agg_context(fcinfo, "hll_add_transfn");
+	struct HllState *st;
+	uint64_t io[MAX_IO_VALUES];
+
+	st = PG_ARGISNULL(0) ? NULL : (struct HllState *) PG_GETARG_POINTER(0);
+	if (st == NULL) {
+		if (PG_ARGISNULL(2) || PG_ARGISNULL(3))
+			elog(ERROR, "hll parameters must not be NULL");
+		st = hll_create(aggctx, hlib_load_string_hash(fcinfo, PG_GETARG_TEXT_PP(2)),
+				PG_GETARG_INT32(3));
+	}
+	if (PG_ARGISNULL(1))
+		PG_RETURN_POINTER(st);
+
+	/* same as hash64_string(value, algo) */
+	memset(io, 0, sizeof(io));
+	io[0] = st->desc->initval;
+	hlib_hash_varlena(st->desc->hash, st->desc->stream, PG_GETARG_DATUM(1), io);
+	hll_add_hash(st, aggctx, io[0]);
+
+	PG_RETURN_POINTER(st);
+}
+
+/* hll_union_transfn(internal, hll) returns internal */
+Datum
+pg_hll_union_transfn(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggctx = hlib_agg_context(fcinfo, "hll_union_transfn");
+	struct HllState *st, *src;
+
+	st = PG_ARGISNULL(0) ? NULL : (struct HllState *) PG_GETARG_POINTER(0);
+	if (PG_ARGISNULL(1)) {
+		/* no state until first non-NULL value */
+		if (st == NULL)
+			PG_RETURN_NULL();
+		PG_RETURN_POINTER(st);
+	}
+
+	src = PG_GETARG_HLL(1, st ? CurrentMemoryContext : aggctx);
+	if (st == NULL)
+		PG_RETURN_POINTER(src);
+	hll_merge(st, aggctx, src);
+	PG_RETURN_POINTER(st);
+}
+
+/* hll_combine(internal, internal) returns internal */
+Datum
+pg_hll_combine(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggctx = hlib_agg_context(fcinfo, "hll_combine");
+	struct HllState *st1, *st2;
+
+	st1 = PG_ARGISNULL(0) ? NULL : (struct HllState *) PG_GETARG_POINTER(0);
+	st2 = PG_ARGISNULL(1) ? NULL : (struct HllState *) PG_GETARG_POINTER(1);
+
+	if (st2 == NULL) {
+		if (st1 == NULL)
+			PG_RETURN_NULL();
+		PG_RETURN_POINTER(st1);
+	}
+	if (st1 == NULL) {
+		bytea *tmp = hll_serialize(st2);
+		PG_RETURN_POINTER(hll_deserialize(aggctx, VARDATA(tmp), VARSIZE(tmp) - VARHDRSZ));
+	}
+	hll_merge(st1, aggctx, st2);
+	PG_RETURN_POINTER(st1);
+}
+
+/* hll_serial(internal) returns bytea */
+Datum
+pg_hll_serial(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_BYTEA_P(hll_serialize((struct HllState *) PG_GETARG_POINTER(0)));
+}
+
+/* hll_deserial(bytea, internal) returns internal */
+Datum
+pg_hll_deserial(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggctx = hlib_agg_context(fcinfo, "hll_deserial");
+
+	PG_RETURN_POINTER(PG_GETARG_HLL(0, aggctx));
+}
+
+/* hll_final(internal) returns hll */
+Datum
+pg_hll_final(PG_FUNCTION_ARGS)
+{
+	if (PG_ARGISNULL(0))
+		PG_RETURN_NULL();
+	PG_RETURN_BYTEA_P(hll_serialize((struct HllState *) PG_GETARG_POINTER(0)));
+}
+
+/*
+ * Functions.
+ */
+
+/* hll_union(hll, hll) returns hll */
+Datum
+pg_hll_union(PG_FUNCTION_ARGS)
+{
+	struct HllState *st1 = PG_GETARG_HLL(0, CurrentMemoryContext);
+	struct HllState *st2 = PG_GETARG_HLL(1, CurrentMemoryContext);
+
+	hll_merge(st1, CurrentMemoryContext, st2);
+	PG_RETURN_BYTEA_P(hll_serialize(st1));
+}
+
+/* hll_cardinality(hll) returns float8 */
+Datum
+pg_hll_cardinality(PG_FUNCTION_ARGS)
+{
+	struct HllState *st = PG_GETARG_HLL(0, CurrentMemoryContext);
+	double m = HLL_NREGS(st);
+	double alpha, sum = 0, est;
+	int zeros = 0;
+	int i;
+
+	if (st->regs) {
+		for (i = 0; i < HLL_NREGS(st); i++) {
+			sum += ldexp(1.0, -st->regs[i]);
+			if (st->regs[i] == 0)
+				zeros++;
+		}
+	} else {
+		/* entries are unique after deserialize */
+		for (i = 0; i < st->nsparse; i++)
+			sum += ldexp(1.0, -(int) HLL_ENTRY_RANK(st->sparse[i]));
+		zeros = HLL_NREGS(st) - st->nsparse;
+		sum += zeros;
+	}
+
+	switch (HLL_NREGS(st)) {
+	case 16:
+		alpha = 0.673;
+		break;
+	case 32:
+		alpha = 0.697;
+		break;
+	case 64:
+		alpha = 0.709;
+		break;
+	default:
+		alpha = 0.7213 / (1 + 1.079 / m);
+	}
+	est = alpha * m * m / sum;
+
+	/* small range correction: linear counting */
+	if (est <= 2.5 * m && zeros > 0)
+		est = m * log(m / zeros);
+
+	/* large range correction for 32-bit hashes */
+	if (st->hashbits == 32 && est > 4294967296.0 / 30)
+		est = -4294967296.0 * log(1 - est / 4294967296.0);
+
+	PG_RETURN_FLOAT8(est);
+}
+
+#endif
@@ -0,0 +1,356 @@
+/*
+ * MinHash signatures.
+ *
+ * Signature slot i (counting from 1) is minimum over elements of
+ * hash64_string(element, algo, i), compared as unsigned.  All seeds
+ * are computed in one pass over element, so only hashes that have
+ * multi-seed version are supported.
+ *
+ * Signature is int8[] of k values, fraction of equal slots estimates
+ * Jaccard similarity of element sets.
+ */
+
+#include "pghashlib.h"
+
+#if PG_VERSION_NUM >= 90600
+
+#include "catalog/pg_type.h"
+#include "libpq/pqformat.h"
+#include "utils/array.h"
+#include "utils/builtins.h"
+
+#define MINHASH_MAX_SIZE	1024
+
+PG_FUNCTION_INFO_V1(pg_minhash_transfn);
+PG_FUNCTION_INFO_V1(pg_minhash_combine);
+PG_FUNCTION_INFO_V1(pg_minhash_serial);
+PG_FUNCTION_INFO_V1(pg_minhash_deserial);
+PG_FUNCTION_INFO_V1(pg_minhash_final);
+PG_FUNCTION_INFO_V1(pg_minhash_array);
+PG_FUNCTION_INFO_V1(pg_minhash_similarity);
+PG_FUNCTION_INFO_V1(pg_minhash_bands);
+
+struct MultiHashDesc {
+	const char *name;
+	hlib_multi_hash_fn hash;
+};
+
+static const struct MultiHashDesc multi_hash_list[] = {
+	{ "murmur3",	hlib_murmur3_multi },
+	{ "city64",	hlib_cityhash64_multi },
+	{ NULL },
+};
+
+struct MinHashState {
+	const struct StrHashDesc *desc;
+	hlib_multi_hash_fn hash;
+	int k;
+	uint64_t *seeds;
+	uint64_t *tmp;		/* hashes of current element */
+	uint64_t mins[FLEXIBLE_ARRAY_MEMBER];
+};
+
+/*
+ * Utility functions.
+ */
+
+static hlib_multi_hash_fn
+find_multi_hash(const struct StrHashDesc *desc)
+{
+	const struct MultiHashDesc *mh;
+
+	for (mh = multi_hash_list; mh->name; mh++) {
+		if (strcmp(mh->name, desc->name) == 0)
+			return mh->hash;
+	}
+	elog(ERROR, "hash '%s' does not support minhash", desc->name);
+	return NULL;
+}
+
+static struct MinHashState *
+minhash_create(MemoryContext mcxt, const struct StrHashDesc *desc, int k)
+{
+	struct MinHashState *st;
+	int i;
+
+	if (k < 1 || k > MINHASH_MAX_SIZE)
+		elog(ERROR, "minhash size must be between 1 and %d", MINHASH_MAX_SIZE);
+
+	st = MemoryContextAlloc(mcxt, offsetof(struct MinHashState, mins) + 3 * k * sizeof(uint64_t));
+	st->desc = desc;
+	st->hash = find_multi_hash(desc);
+	st->k = k;
+	st->seeds = st->mins + k;
+	st->tmp = st->mins + 2 * k;
+	for (i = 0; i < k; i++) {
+		st->mins[i] = UINT64_MAX;
+		st->seeds[i] = i + 1;
+	}
+	return st;
+}
+
+static void
+minhash_add(struct MinHashState *st, const void *data, size_t len)
+{
+	int i;
+
+	st->hash(data, len, st->seeds, st->tmp, st->k);
+	for (i = 0; i < st->k; i++) {
+		if (st->tmp[i] < st->mins[i])
+			st->mins[i] = st->tmp[i];
+	}
+}
+
+static void
+minhash_merge(struct MinHashState *dst, const struct MinHashState *src)
+{
+	int i;
+
+	if (dst->desc != src->desc || dst->k != src->k)
+		elog(ERROR, "cannot combine minhash signatures with different parameters");
+	for (i = 0; i < dst->k; i++) {
+		if (src->mins[i] < dst->mins[i])
+			dst->mins[i] = src->mins[i];
+	}
+}
+
+static ArrayType *
+make_signature(const uint64_t *vals, int n)
+{
+	Datum *elems = palloc(n * sizeof(Datum));
+	int i;
+
+	for (i = 0; i < n; i++)
+		elems[i] = Int64GetDatum(vals[i]);
+	return construct_array(elems, n, INT8OID, 8, FLOAT8PASSBYVAL, 'd');
+}
+
+/* signature values, checked to be one-dimensional without NULLs */
+static const int64 *
+signature_values(ArrayType *sig, int *n)
+{
+	if (ARR_ELEMTYPE(sig) != INT8OID || ARR_HASNULL(sig) || ARR_NDIM(sig) > 1)
+		elog(ERROR, "minhash signature must be one-dimensional int8[] without NULLs");
+	*n = ArrayGetNItems(ARR_NDIM(sig), ARR_DIMS(sig));
+	return (const int64 *) ARR_DATA_PTR(sig);
+}
+
+/*
+ * Aggregate.
+ */
+
+/* minhash_agg_transfn(internal, bytea, int4, text) returns internal */
+Datum
+pg_minhash_transfn(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggctx = hlib_agg_context(fcinfo, "minhash_agg_transfn");
+	struct MinHashState *st;
+	struct varlena *data;
+
+	st = PG_ARGISNULL(0) ? NULL : (struct MinHashState *) PG_GETARG_POINTER(0);
+	if (PG_ARGISNULL(1)) {
+		/* no state until first non-NULL value */
+		if (st == NULL)
+			PG_RETURN_NULL();
+		PG_RETURN_POINTER(st);
+	}
+
+	if (st == NULL) {
+		if (PG_ARGISNULL(2) || PG_ARGISNULL(3))
+			elog(ERROR, "minhash parameters must not be NULL");
+		st = minhash_create(aggctx, hlib_load_string_hash(fcinfo, PG_GETARG_TEXT_PP(3)),
+				    PG_GETARG_INT32(2));
+	}
+
+	/* request aligned data on weird architectures */
+#ifdef HLIB_UNALIGNED_READ_OK
+	data = PG_GETARG_VARLENA_PP(1);
+#else
+	data = PG_GETARG_VARLENA_P(1);
+#endif
+
+	minhash_add(st, VARDATA_ANY(data), VARSIZE_ANY_EXHDR(data));
+
+	PG_FREE_IF_COPY(data, 1);
+
+	PG_RETURN_POINTER(st);
+}
+
+/* minhash_agg_combine(internal, internal) returns internal */
+Datum
+pg_minhash_combine(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggctx = hlib_agg_context(fcinfo, "minhash_agg_combine");
+	struct MinHashState *st1, *st2;
+
+	st1 = PG_ARGISNULL(0) ? NULL : (struct MinHashState *) PG_GETARG_POINTER(0);
+	st2 = PG_ARGISNULL(1) ? NULL : (struct MinHashState *) PG_GETARG_POINTER(1);
+
+	if (st2 == NULL) {
+		if (st1 == NULL)
+			PG_RETURN_NULL();
+		PG_RETURN_POINTER(st1);
+	}
+	if (st1 == NULL) {
+		st1 = minhash_create(aggctx, st2->desc, st2->k);
+		memcpy(st1->mins, st2->mins, st2->k * sizeof(uint64_t));
+		PG_RETURN_POINTER(st1);
+	}
+
+	minhash_merge(st1, st2);
+	PG_RETURN_POINTER(st1);
+}
+
+/* minhash_agg_serial(internal) returns bytea */
+Datum
+pg_minhash_serial(PG_FUNCTION_ARGS)
+{
+	struct MinHashState *st = (struct MinHashState *) PG_GETARG_POINTER(0);
+	StringInfoData buf;
+	int i;
+
+	pq_begintypsend(&buf);
+	pq_sendbyte(&buf, st->desc->namelen);
+	pq_sendbytes(&buf, st->desc->name, st->desc->namelen);
+	for (i = 0; i < st->k; i++)
+		pq_sendint64(&buf, st->mins[i]);
+	PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+/* minhash_agg_deserial(bytea, internal) returns internal */
+Datum
+pg_minhash_deserial(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggctx = hlib_agg_context(fcinfo, "minhash_agg_deserial");
+	bytea *data = PG_GETARG_BYTEA_PP(0);
+	const struct StrHashDesc *desc;
+	struct MinHashState *st;
+	StringInfoData buf;
+	int nlen, i;
+
+	buf.data = VARDATA_ANY(data);
+	buf.len = VARSIZE_ANY_EXHDR(data);
+	buf.maxlen = buf.len;
+	buf.cursor = 0;
+
+	nlen = pq_getmsgbyte(&buf);
+	desc = hlib_find_string_hash(pq_getmsgbytes(&buf, nlen), nlen);
+	if (desc == NULL)
+		elog(ERROR, "invalid aggregate state: unknown hash");
+
+	/* rest is signature */
+	st = minhash_create(aggctx, desc, (buf.len - buf.cursor) / 8);
+	for (i = 0; i < st->k; i++)
+		st->mins[i] = pq_getmsgint64(&buf);
+	pq_getmsgend(&buf);
+
+	PG_RETURN_POINTER(st);
+}
+
+/* minhash_agg_final(internal) returns int8[] */
+Datum
+pg_minhash_final(PG_FUNCTION_ARGS)
+{
+	struct MinHashState *st;
+
+	if (PG_ARGISNULL(0))
+		PG_RETURN_NULL();
+	st = (struct MinHashState *) PG_GETARG_POINTER(0);
+	PG_RETURN_ARRAYTYPE_P(make_signature(st->mins, st->k));
+}
+
+/*
+ * Functions.
+ */
+
+/* minhash(bytea[], int4 [, text]) returns int8[] */
+Datum
+pg_minhash_array(PG_FUNCTION_ARGS)
+{
+	ArrayType *arr = PG_GETARG_ARRAYTYPE_P(0);
+	int k = PG_GETARG_INT32(1);
+	const struct StrHashDesc *desc;
+	struct MinHashState *st;
+	Datum *elems;
+	bool *nulls;
+	int nelems, nvalues = 0;
+	int i;
+
+	if (PG_NARGS() >= 3)
+		desc = hlib_load_string_hash(fcinfo, PG_GETARG_TEXT_PP(2));
+	else
+		desc = hlib_find_string_hash("city64", 6);
+	st = minhash_create(CurrentMemoryContext, desc, k);
+
+	deconstruct_array(arr, ARR_ELEMTYPE(arr), -1, false, 'i', &elems, &nulls, &nelems);
+	for (i = 0; i < nelems; i++) {
+		if (nulls[i])
+			continue;
+		minhash_add(st, VARDATA_ANY(elems[i]), VARSIZE_ANY_EXHDR(elems[i]));
+		nvalues++;
+	}
+
+	/* same as aggregate over no values */
+	if (nvalues == 0)
+		PG_RETURN_NULL();
+	PG_RETURN_ARRAYTYPE_P(make_signature(st->mins, st->k));
+}
+
+/* minhash_similarity(int8[], int8[]) returns float8 */
+Datum
+pg_minhash_similarity(PG_FUNCTION_ARGS)
+{
+	ArrayType *sig1 = PG_GETARG_ARRAYTYPE_P(0);
+	ArrayType *sig2 = PG_GETARG_ARRAYTYPE_P(1);
+	const int64 *v1, *v2;
+	int n1, n2, i;
+	int same = 0;
+
+	v1 = signature_values(sig1, &n1);
+	v2 = signature_values(sig2, &n2);
+	if (n1 != n2 || n1 == 0)
+		elog(ERROR, "minhash signatures must have same non-zero size");
+
+	for (i = 0; i < n1; i++)
+		same += (v1[i] == v2[i]);
+	PG_RETURN_FLOAT8((double) same / n1);
+}
+
+/*
+ * Split signature into b bands of r values, return key for each band.
+ *
+ * Key of band j (counting from 1) is city64 hash of band values in
+ * little-endian, with j as seed.  Signatures that have any equal key
+ * are candidates for near-duplicates.
+ */
+
+/* minhash_bands(int8[], int4, int4) returns int8[] */
+Datum
+pg_minhash_bands(PG_FUNCTION_ARGS)
+{
+	ArrayType *sig = PG_GETARG_ARRAYTYPE_P(0);
+	int nbands = PG_GETARG_INT32(1);
+	int rows = PG_GETARG_INT32(2);
+	const int64 *vals;
+	uint64_t *band, *keys;
+	uint64_t io[MAX_IO_VALUES];
+	int n, i, j;
+
+	vals = signature_values(sig, &n);
+	if (nbands < 1 || rows < 1 || (int64) nbands * rows > n)
+		elog(ERROR, "minhash bands must be positive and fit into signature of size %d", n);
+
+	band = palloc(rows * sizeof(uint64_t));
+	keys = palloc(nbands * sizeof(uint64_t));
+	for (i = 0; i < nbands; i++) {
+		for (j = 0; j < rows; j++)
+			band[j] = htole64(vals[i * rows + j]);
+		io[0] = i + 1;
+		io[1] = 0;
+		hlib_cityhash64(band, rows * sizeof(uint64_t), io);
+		keys[i] = io[0];
+	}
+	PG_RETURN_ARRAYTYPE_P(make_signature(keys, nbands));
+}
+
+#endif
@@ -0,0 +1,450 @@
+/*
+ * Consistent hash ring with virtual nodes.
+ *
+ * Point of virtual node i (counting from 0) is
+ * hash64_string(node || '-' || i, algo), key is placed on first point
+ * that is not less than hash64_string(key, algo), compared as unsigned,
+ * wrapping around after last point.
+ *
+ * Binary format (send/recv, text I/O is same in hex):
+ *
+ *   byte 0       version, 1
+ *   bytes 1-3    reserved, 0
+ *   bytes 4-7    number of nodes, uint32 little-endian
+ *   bytes 8-11   virtual nodes per node, uint32 little-endian
+ *   bytes 12-15  number of points, uint32 little-endian
+ *   bytes 16-23  checksum, city64 of data after header, little-endian
+ *   bytes 24-39  algorithm name, zero-padded
+ *   bytes 40-    points as uint64 little-endian, sorted,
+ *                then node index of each point as uint32 little-endian,
+ *                then node names as length uint32 little-endian and bytes
+ *
+ * Checksum also identifies ring in per-call-site cache, so lookups
+ * need to read only header of ring value.
+ */
+
+#include "pghashlib.h"
+
+#if PG_VERSION_NUM >= 90600
+
+#include <math.h>
+
+#include "catalog/pg_type.h"
+#include "libpq/pqformat.h"
+#include "utils/array.h"
+#include "utils/builtins.h"
+#include "utils/memutils.h"
+
+#define RING_VERSION		1
+#define RING_ALGO_LEN		16
+#define RING_HDRSZ		40
+#define RING_MAX_POINTS		(16 * 1024 * 1024)
+
+struct Ring {
+	const struct StrHashDesc *desc;
+	uint32 nnodes;
+	uint32 vnodes;
+	uint32 npoints;
+	uint64 checksum;
+	uint64_t *points;
+	uint32 *owners;
+	text **names;
+};
+
+/* per-call-site cache in fn_extra */
+struct RingCache {
+	MemoryContext ringcxt;
+	bool valid;
+	struct Ring ring;
+	uint32 *loads;		/* scratch space for ring_assign() */
+};
+
+PG_FUNCTION_INFO_V1(pg_ring_in);
+PG_FUNCTION_INFO_V1(pg_ring_out);
+PG_FUNCTION_INFO_V1(pg_ring_recv);
+PG_FUNCTION_INFO_V1(pg_ring_send);
+PG_FUNCTION_INFO_V1(pg_ring_build);
+PG_FUNCTION_INFO_V1(pg_ring_lookup);
+PG_FUNCTION_INFO_V1(pg_ring_assign);
+
+/*
+ * Binary format.
+ */
+
+static uint64
+ring_checksum(const char *data, int len)
+{
+	uint64_t io[MAX_IO_VALUES] = { 0, 0 };
+
+	hlib_cityhash64(data, len, io);
+	return io[0];
+}
+
+static bytea *
+ring_serialize(const struct Ring *ring)
+{
+	StringInfoData buf;
+	char algo[RING_ALGO_LEN];
+	uint64 checksum;
+	uint32 i;
+
+	memset(algo, 0, sizeof(algo));
+	memcpy(algo, ring->desc->name, ring->desc->namelen);
+
+	pq_begintypsend(&buf);
+	pq_sendbyte(&buf, RING_VERSION);
+	pq_sendbyte(&buf, 0);
+	pq_sendbyte(&buf, 0);
+	pq_sendbyte(&buf, 0);
+	hlib_put_le32(&buf, ring->nnodes);
+	hlib_put_le32(&buf, ring->vnodes);
+	hlib_put_le32(&buf, ring->npoints);
+	hlib_put_le64(&buf, 0);
+	pq_sendbytes(&buf, algo, RING_ALGO_LEN);
+	for (i = 0; i < ring->npoints; i++)
+		hlib_put_le64(&buf, ring->points[i]);
+	for (i = 0; i < ring->npoints; i++)
+		hlib_put_le32(&buf, ring->owners[i]);
+	for (i = 0; i < ring->nnodes; i++) {
+		hlib_put_le32(&buf, VARSIZE_ANY_EXHDR(ring->names[i]));
+		pq_sendbytes(&buf, VARDATA_ANY(ring->names[i]), VARSIZE_ANY_EXHDR(ring->names[i]));
+	}
+
+	/* checksum of data after header, buffer starts with varlena header */
+	checksum = htole64(ring_checksum(buf.data + VARHDRSZ + RING_HDRSZ, buf.len - VARHDRSZ - RING_HDRSZ));
+	memcpy(buf.data + VARHDRSZ + 16, &checksum, 8);
+	return pq_endtypsend(&buf);
+}
+
+/* parse header, leaves cursor at points */
+static void
+ring_read_header(StringInfo buf, struct Ring *ring)
+{
+	if (buf->len < RING_HDRSZ || pq_getmsgbyte(buf) != RING_VERSION)
+		elog(ERROR, "invalid hashlib_ring: unsupported version");
+	buf->cursor += 3;
+	ring->nnodes = hlib_get_le32(buf);
+	ring->vnodes = hlib_get_le32(buf);
+	ring->npoints = hlib_get_le32(buf);
+	ring->checksum = hlib_get_le64(buf);
+	ring->desc = hlib_find_string_hash(buf->data + buf->cursor, strnlen(buf->data + buf->cursor, RING_ALGO_LEN));
+	if (ring->desc == NULL)
+		elog(ERROR, "invalid hashlib_ring: unknown hash");
+	buf->cursor += RING_ALGO_LEN;
+}
+
+/* full parse and validation, arrays are allocated in current context */
+static void
+ring_deserialize(const char *data, int len, struct Ring *ring)
+{
+	StringInfoData buf;
+	uint32 i, nlen;
+
+	buf.data = (char *) data;
+	buf.len = len;
+	buf.maxlen = len;
+	buf.cursor = 0;
+
+	ring_read_header(&buf, ring);
+	if (ring->nnodes < 1 || ring->vnodes < 1 || ring->npoints > RING_MAX_POINTS
+	    || (uint64) ring->nnodes * ring->vnodes != ring->npoints
+	    || buf.len - buf.cursor < (int64) ring->npoints * 12 + (int64) ring->nnodes * 4)
+		elog(ERROR, "invalid hashlib_ring: bad size");
+	if (ring_checksum(buf.data + buf.cursor, buf.len - buf.cursor) != ring->checksum)
+		elog(ERROR, "invalid hashlib_ring: bad checksum");
+
+	ring->points = palloc(ring->npoints * sizeof(uint64_t));
+	ring->owners = palloc(ring->npoints * sizeof(uint32));
+	ring->names = palloc(ring->nnodes * sizeof(text *));
+	for (i = 0; i < ring->npoints; i++) {
+		ring->points[i] = hlib_get_le64(&buf);
+		if (i > 0 && ring->points[i] < ring->points[i - 1])
+			elog(ERROR, "invalid hashlib_ring: points not sorted");
+	}
+	for (i = 0; i < ring->npoints; i++) {
+		ring->owners[i] = hlib_get_le32(&buf);
+		if (ring->owners[i] >= ring->nnodes)
+			elog(ERROR, "invalid hashlib_ring: bad node index");
+	}
+	for (i = 0; i < ring->nnodes; i++) {
+		nlen = hlib_get_le32(&buf);
+		if (nlen > (uint32) (buf.len - buf.cursor))
+			elog(ERROR, "invalid hashlib_ring: bad size");
+		ring->names[i] = cstring_to_text_with_len(pq_getmsgbytes(&buf, nlen), nlen);
+	}
+	pq_getmsgend(&buf);
+}
+
+/*
+ * Load ring into cache.  Only header is read if ring is already
+ * cached, without detoasting whole value.
+ */
+static struct Ring *
+load_ring(FunctionCallInfo fcinfo, Datum value)
+{
+	struct RingCache *cache = fcinfo->flinfo->fn_extra;
+	struct varlena *attr = (struct varlena *) DatumGetPointer(value);
+	struct varlena *hdr = attr;
+	struct varlena *data;
+	MemoryContext oldctx;
+	StringInfoData buf;
+	struct Ring tmp;
+
+	if (cache == NULL) {
+		cache = MemoryContextAllocZero(fcinfo->flinfo->fn_mcxt, sizeof(*cache));
+		cache->ringcxt = AllocSetContextCreate(fcinfo->flinfo->fn_mcxt, "hashlib_ring",
+						       ALLOCSET_DEFAULT_SIZES);
+		fcinfo->flinfo->fn_extra = cache;
+	}
+
+	if (VARATT_IS_EXTENDED(attr) && !VARATT_IS_SHORT(attr))
+		hdr = PG_DETOAST_DATUM_SLICE(value, 0, RING_HDRSZ);
+	buf.data = VARDATA_ANY(hdr);
+	buf.len = VARSIZE_ANY_EXHDR(hdr);
+	buf.maxlen = buf.len;
+	buf.cursor = 0;
+	ring_read_header(&buf, &tmp);
+	if (hdr != attr)
+		pfree(hdr);
+
+	if (cache->valid && cache->ring.checksum == tmp.checksum && cache->ring.desc == tmp.desc
+	    && cache->ring.npoints == tmp.npoints && cache->ring.nnodes == tmp.nnodes)
+		return &cache->ring;
+
+	cache->valid = false;
+	MemoryContextReset(cache->ringcxt);
+	oldctx = MemoryContextSwitchTo(cache->ringcxt);
+	data = PG_DETOAST_DATUM(value);
+	ring_deserialize(VARDATA_ANY(data), VARSIZE_ANY_EXHDR(data), &cache->ring);
+	cache->loads = palloc(cache->ring.nnodes * sizeof(uint32));
+	MemoryContextSwitchTo(oldctx);
+	cache->valid = true;
+	return &cache->ring;
+}
+
+/* index of first point not less than hash, branchless */
+static uint32
+ring_search(const struct Ring *ring, uint64_t hash)
+{
+	const uint64_t *base = ring->points;
+	uint32 len = ring->npoints;
+	uint32 half, idx;
+
+	while (len > 1) {
+		half = len / 2;
+		base = (base[half - 1] < hash) ? base + half : base;
+		len -= half;
+	}
+	idx = (base - ring->points) + (*base < hash);
+
+	/* wrap around */
+	return (idx == ring->npoints) ? 0 : idx;
+}
+
+/* same as hash64_string(key, algo) */
+static uint64_t
+ring_hash_key(const struct Ring *ring, Datum key)
+{
+	uint64_t io[MAX_IO_VALUES];
+
+	memset(io, 0, sizeof(io));
+	io[0] = ring->desc->initval;
+	hlib_hash_varlena(ring->desc->hash, ring->desc->stream, key, io);
+	return io[0];
+}
+
+/*
+ * Type I/O.
+ */
+
+/* hashlib_ring_in(cstring) returns hashlib_ring */
+Datum
+pg_ring_in(PG_FUNCTION_ARGS)
+{
+	const char *str = PG_GETARG_CSTRING(0);
+	struct Ring ring;
+	bytea *res;
+
+	res = hlib_hex_in(str, "hashlib_ring");
+	ring_deserialize(VARDATA(res), VARSIZE(res) - VARHDRSZ, &ring);
+	PG_RETURN_BYTEA_P(res);
+}
+
+/* hashlib_ring_out(hashlib_ring) returns cstring */
+Datum
+pg_ring_out(PG_FUNCTION_ARGS)
+{
+	bytea *data = PG_GETARG_BYTEA_PP(0);
+
+	PG_RETURN_CSTRING(hlib_hex_out(VARDATA_ANY(data), VARSIZE_ANY_EXHDR(data)));
+}
+
+/* hashlib_ring_recv(internal) returns hashlib_ring */
+Datum
+pg_ring_recv(PG_FUNCTION_ARGS)
+{
+	StringInfo buf = (StringInfo) PG_GETARG_POINTER(0);
+	int len = buf->len - buf->cursor;
+	struct Ring ring;
+	bytea *res;
+
+	res = palloc(VARHDRSZ + len);
+	SET_VARSIZE(res, VARHDRSZ + len);
+	pq_copymsgbytes(buf, VARDATA(res), len);
+	ring_deserialize(VARDATA(res), len, &ring);
+	PG_RETURN_BYTEA_P(res);
+}
+
+/* hashlib_ring_send(hashlib_ring) returns bytea */
+Datum
+pg_ring_send(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_BYTEA_P(PG_GETARG_BYTEA_P(0));
+}
+
+/*
+ * Functions.
+ */
+
+struct RingPoint {
+	uint64_t point;
+	uint32 owner;
+};
+
+static int
+cmp_point(const void *a, const void *b)
+{
+	const struct RingPoint *p1 = a;
+	const struct RingPoint *p2 = b;
+
+	if (p1->point != p2->point)
+		return (p1->point < p2->point) ? -1 : 1;
+	return (p1->owner < p2->owner) ? -1 : (p1->owner > p2->owner) ? 1 : 0;
+}
+
+/* ring_build(text[], int4, text) returns hashlib_ring */
+Datum
+pg_ring_build(PG_FUNCTION_ARGS)
+{
+	ArrayType *nodes = PG_GETARG_ARRAYTYPE_P(0);
+	int32 vnodes = PG_GETARG_INT32(1);
+	struct Ring ring;
+	struct RingPoint *pts;
+	StringInfoData key;
+	uint64_t io[MAX_IO_VALUES];
+	Datum *names;
+	bool *nulls;
+	int nnodes;
+	uint32 i, j, n = 0;
+
+	ring.desc = hlib_load_string_hash(fcinfo, PG_GETARG_TEXT_PP(2));
+
+	if (ARR_NDIM(nodes) > 1)
+		elog(ERROR, "nodes must be one-dimensional array");
+	deconstruct_array(nodes, TEXTOID, -1, false, 'i', &names, &nulls, &nnodes);
+	if (nnodes == 0)
+		elog(ERROR, "nodes must not be empty");
+	if (vnodes < 1 || (int64) vnodes * nnodes > RING_MAX_POINTS)
+		elog(ERROR, "virtual nodes must be positive and total points at most %d", RING_MAX_POINTS);
+
+	ring.nnodes = nnodes;
+	ring.vnodes = vnodes;
+	ring.npoints = nnodes * vnodes;
+	ring.names = palloc(nnodes * sizeof(text *));
+	pts = palloc(ring.npoints * sizeof(struct RingPoint));
+
+	initStringInfo(&key);
+	for (i = 0; i < ring.nnodes; i++) {
+		if (nulls[i])
+			elog(ERROR, "node names must not be NULL");
+		ring.names[i] = DatumGetTextPP(names[i]);
+
+		/* point is hash64_string(node || '-' || vnode, algo) */
+		for (j = 0; j < ring.vnodes; j++) {
+			resetStringInfo(&key);
+			appendBinaryStringInfo(&key, VARDATA_ANY(ring.names[i]), VARSIZE_ANY_EXHDR(ring.names[i]));
+			appendStringInfo(&key, "-%u", j);
+
+			memset(io, 0, sizeof(io));
+			io[0] = ring.desc->initval;
+			ring.desc->hash(key.data, key.len, io);
+			pts[n].point = io[0];
+			pts[n].owner = i;
+			n++;
+		}
+	}
+	qsort(pts, n, sizeof(struct RingPoint), cmp_point);
+
+	ring.points = palloc(n * sizeof(uint64_t));
+	ring.owners = palloc(n * sizeof(uint32));
+	for (i = 0; i < n; i++) {
+		ring.points[i] = pts[i].point;
+		ring.owners[i] = pts[i].owner;
+	}
+	PG_RETURN_BYTEA_P(ring_serialize(&ring));
+}
+
+/* ring_lookup(hashlib_ring, bytea) returns text */
+Datum
+pg_ring_lookup(PG_FUNCTION_ARGS)
+{
+	struct Ring *ring = load_ring(fcinfo, PG_GETARG_DATUM(0));
+	uint32 idx;
+
+	idx = ring_search(ring, ring_hash_key(ring, PG_GETARG_DATUM(1)));
+	PG_RETURN_TEXT_P(DatumGetTextPCopy(PointerGetDatum(ring->names[ring->owners[idx]])));
+}
+
+/*
+ * Consistent hashing with bounded loads, from "Consistent Hashing with
+ * Bounded Loads" by Mirrokni, Thorup and Zadimoghaddam.  Keys are placed
+ * in order, each on first node clockwise that has less than
+ * ceil(c * keys / nodes) keys.
+ */
+
+/* ring_assign(hashlib_ring, text[], float8) returns text[] */
+Datum
+pg_ring_assign(PG_FUNCTION_ARGS)
+{
+	struct Ring *ring = load_ring(fcinfo, PG_GETARG_DATUM(0));
+	ArrayType *keys = PG_GETARG_ARRAYTYPE_P(1);
+	float8 c = PG_GETARG_FLOAT8(2);
+	struct RingCache *cache = fcinfo->flinfo->fn_extra;
+	uint32 *loads = cache->loads;
+	Datum *elems;
+	bool *nulls;
+	Datum *res;
+	int nkeys, i;
+	double cap;
+	uint32 capacity, idx, owner;
+	ArrayType *arr;
+
+	if (!(c >= 1))
+		elog(ERROR, "load factor must be at least 1");
+
+	deconstruct_array(keys, ARR_ELEMTYPE(keys), -1, false, 'i', &elems, &nulls, &nkeys);
+	cap = ceil(c * nkeys / ring->nnodes);
+	capacity = (cap > PG_UINT32_MAX) ? PG_UINT32_MAX : (uint32) cap;
+	memset(loads, 0, ring->nnodes * sizeof(uint32));
+
+	res = palloc(Max(nkeys, 1) * sizeof(Datum));
+	for (i = 0; i < nkeys; i++) {
+		if (nulls[i])
+			continue;
+		idx = ring_search(ring, ring_hash_key(ring, elems[i]));
+		while (loads[ring->owners[idx]] >= capacity)
+			idx = (idx + 1 == ring->npoints) ? 0 : idx + 1;
+		owner = ring->owners[idx];
+		loads[owner]++;
+		res[i] = PointerGetDatum(ring->names[owner]);
+	}
+
+	/* result has same shape as input, NULL keys stay NULL */
+	if (nkeys == 0)
+		PG_RETURN_ARRAYTYPE_P(construct_empty_array(TEXTOID));
+	arr = construct_md_array(res, nulls, ARR_NDIM(keys), ARR_DIMS(keys), ARR_LBOUND(keys),
+				 TEXTOID, -1, false, 'i');
+	PG_RETURN_ARRAYTYPE_P(arr);
+}
+
+#endif
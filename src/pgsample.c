@@ -0,0 +1,286 @@
+/*
+ * Hash-based TABLESAMPLE method.
+ *
+ *   SELECT ... FROM t TABLESAMPLE hashlib(column text, percent float4, algo text)
+ *
+ * Row is kept when hash of key column falls under percent of hash range,
+ * so same key is always in or out of sample, regardless of physical
+ * row order, REPEATABLE seed or server.  Key is hashed in tuple loop,
+ * every page is read.
+ */
+
+#include "pghashlib.h"
+
+#if PG_VERSION_NUM >= 90600
+
+#include "access/heapam.h"
+#include "access/htup_details.h"
+#include "access/relscan.h"
+#include "access/tsmapi.h"
+#include "catalog/pg_type.h"
+#include "miscadmin.h"
+#include "nodes/execnodes.h"
+#include "utils/acl.h"
+#include "utils/builtins.h"
+#include "utils/lsyscache.h"
+#include "utils/rel.h"
+
+#if PG_VERSION_NUM >= 120000
+#include "catalog/pg_am.h"
+#include "optimizer/optimizer.h"
+#else
+#include "optimizer/clauses.h"
+#include "optimizer/cost.h"
+#include "utils/tqual.h"
+#endif
+
+#if PG_VERSION_NUM >= 120000
+#define SCAN_PAGEMODE(scan)	(((scan)->rs_base.rs_flags & SO_ALLOW_PAGEMODE) != 0)
+#define SCAN_SNAPSHOT(scan)	((scan)->rs_base.rs_snapshot)
+#else
+#define SCAN_PAGEMODE(scan)	((scan)->rs_pageatatime)
+#define SCAN_SNAPSHOT(scan)	((scan)->rs_snapshot)
+#endif
+
+#if PG_VERSION_NUM >= 110000
+#define ACL_OBJECT_TABLE	OBJECT_TABLE
+#else
+#define ACL_OBJECT_TABLE	ACL_KIND_CLASS
+#endif
+
+/* default sample fraction for planner if percent is not constant */
+#define SAMPLE_DEFAULT_FRACT	0.1
+
+struct HashSampleState {
+	AttrNumber attnum;
+	bool is_int;
+	int16 intlen;
+	const struct StrHashDesc *strdesc;
+	const struct Int64HashDesc *intdesc;
+	bool keep_all;
+	uint64 mask;
+	uint64 threshold;
+	OffsetNumber lt;	/* last tuple returned from current block */
+};
+
+PG_FUNCTION_INFO_V1(pg_hashlib_tsm_handler);
+
+static void
+sample_getsamplesize(PlannerInfo *root, RelOptInfo *baserel, List *paramexprs,
+		     BlockNumber *pages, double *tuples)
+{
+	Node *pctnode = (Node *) lsecond(paramexprs);
+	double fract = SAMPLE_DEFAULT_FRACT;
+	float4 pct;
+
+	pctnode = estimate_expression_value(root, pctnode);
+	if (IsA(pctnode, Const) && !((Const *) pctnode)->constisnull) {
+		pct = DatumGetFloat4(((Const *) pctnode)->constvalue);
+		if (pct >= 0 && pct <= 100)
+			fract = pct / 100.0;
+	}
+
+	/* every page is read */
+	*pages = baserel->pages;
+	*tuples = clamp_row_est(baserel->tuples * fract);
+}
+
+static void
+sample_init(SampleScanState *node, int eflags)
+{
+	node->tsm_state = palloc0(sizeof(struct HashSampleState));
+}
+
+static void
+sample_begin(SampleScanState *node, Datum *params, int nparams, uint32 seed)
+{
+	struct HashSampleState *st = node->tsm_state;
+	Relation rel = node->ss.ss_currentRelation;
+	char *colname = TextDatumGetCString(params[0]);
+	float4 pct = DatumGetFloat4(params[1]);
+	text *algo = DatumGetTextPP(params[2]);
+	Form_pg_attribute att;
+	AclResult aclresult;
+	double fract;
+	int bits = 64;
+
+#if PG_VERSION_NUM >= 120000
+	if (rel->rd_rel->relam != HEAP_TABLE_AM_OID)
+		elog(ERROR, "hashlib sampling supports only heap tables");
+#endif
+
+	if (!(pct >= 0 && pct <= 100))
+		elog(ERROR, "sample percentage must be between 0 and 100");
+
+	/* called again on rescan */
+	st->intdesc = NULL;
+	st->strdesc = NULL;
+
+	st->attnum = get_attnum(RelationGetRelid(rel), colname);
+	if (st->attnum == InvalidAttrNumber)
+		elog(ERROR, "column \"%s\" does not exist", colname);
+	if (st->attnum < 0)
+		elog(ERROR, "cannot sample by system column \"%s\"", colname);
+	att = TupleDescAttr(RelationGetDescr(rel), st->attnum - 1);
+	if (att->attisdropped)
+		elog(ERROR, "column \"%s\" does not exist", colname);
+
+	/* sample reveals key hashes, so key must be readable */
+	aclresult = pg_attribute_aclcheck(RelationGetRelid(rel), st->attnum, GetUserId(), ACL_SELECT);
+	if (aclresult != ACLCHECK_OK)
+		aclcheck_error_col(aclresult, ACL_OBJECT_TABLE,
+				   RelationGetRelationName(rel), colname);
+
+	/* integer keys use integer hashes, same as hash_int8() */
+	st->is_int = (att->atttypid == INT2OID || att->atttypid == INT4OID || att->atttypid == INT8OID);
+	if (st->is_int) {
+		st->intdesc = hlib_find_int64_hash(VARDATA_ANY(algo), VARSIZE_ANY_EXHDR(algo));
+		st->intlen = att->attlen;
+		if (st->intdesc)
+			bits = st->intdesc->bits;
+	} else if (att->attlen == -1) {
+		st->strdesc = hlib_find_string_hash(VARDATA_ANY(algo), VARSIZE_ANY_EXHDR(algo));
+		if (st->strdesc)
+			bits = (st->strdesc->bits == 32) ? 32 : 64;
+	}
+	if (st->intdesc == NULL && st->strdesc == NULL)
+		elog(ERROR, "hash '%s' cannot be used with column of type %s",
+		     text_to_cstring(algo), format_type_be(att->atttypid));
+
+	/* keep row when hash as unsigned is below percent of its range */
+	fract = pct / 100.0;
+	st->keep_all = fract >= 1;
+	if (bits == 32) {
+		st->mask = 0xFFFFFFFF;
+		st->threshold = fract * 4294967296.0;
+	} else {
+		st->mask = ~(uint64) 0;
+		st->threshold = st->keep_all ? 0 : (uint64) (fract * 18446744073709551616.0);
+	}
+	st->lt = InvalidOffsetNumber;
+
+	/* all pages are read, key decides, not seed */
+	node->use_bulkread = true;
+	node->use_pagemode = true;
+}
+
+static bool
+sample_keep(struct HashSampleState *st, Datum value)
+{
+	uint64_t io[MAX_IO_VALUES];
+	uint64_t hash;
+	int64 ival;
+
+	if (st->keep_all)
+		return true;
+
+	if (st->is_int) {
+		if (st->intlen == 2)
+			ival = DatumGetInt16(value);
+		else if (st->intlen == 4)
+			ival = DatumGetInt32(value);
+		else
+			ival = DatumGetInt64(value);
+		hash = st->intdesc->hash(ival);
+	} else {
+		/* same as hash64_string(value, algo) */
+		memset(io, 0, sizeof(io));
+		io[0] = st->strdesc->initval;
+		hlib_hash_varlena(st->strdesc->hash, st->strdesc->stream, value, io);
+		hash = io[0];
+	}
+	return (hash & st->mask) < st->threshold;
+}
+
+/*
+ * Tuple must be checked before key is detoasted, TOAST chunks of
+ * dead tuples may already be vacuumed away.  In page mode visible
+ * offsets are collected by heap scan, otherwise buffer is share-locked
+ * by caller and tuple is checked against scan snapshot.
+ */
+static bool
+sample_visible(HeapScanDesc scan, HeapTuple tuple, OffsetNumber off)
+{
+	int lo, hi, mid;
+
+	if (!SCAN_PAGEMODE(scan))
+		return HeapTupleSatisfiesVisibility(tuple, SCAN_SNAPSHOT(scan), scan->rs_cbuf);
+
+	/* rs_vistuples is sorted */
+	lo = 0;
+	hi = scan->rs_ntuples - 1;
+	while (lo <= hi) {
+		mid = (lo + hi) / 2;
+		if (scan->rs_vistuples[mid] == off)
+			return true;
+		if (scan->rs_vistuples[mid] < off)
+			lo = mid + 1;
+		else
+			hi = mid - 1;
+	}
+	return false;
+}
+
+/*
+ * Called by heap sampling with block pinned, return next offset
+ * whose key is in sample.  Invisible tuples are skipped before
+ * their key is read.
+ */
+static OffsetNumber
+sample_nexttuple(SampleScanState *node, BlockNumber blockno, OffsetNumber maxoffset)
+{
+	struct HashSampleState *st = node->tsm_state;
+	HeapScanDesc scan = (HeapScanDesc) node->ss.ss_currentScanDesc;
+	TupleDesc tupdesc = RelationGetDescr(node->ss.ss_currentRelation);
+	Page page = BufferGetPage(scan->rs_cbuf);
+	OffsetNumber off;
+	HeapTupleData tuple;
+	ItemId itemid;
+	Datum value;
+	bool isnull;
+
+	off = (st->lt == InvalidOffsetNumber) ? FirstOffsetNumber : st->lt + 1;
+	for (; off <= maxoffset; off++) {
+		itemid = PageGetItemId(page, off);
+		if (!ItemIdIsNormal(itemid))
+			continue;
+
+		tuple.t_data = (HeapTupleHeader) PageGetItem(page, itemid);
+		tuple.t_len = ItemIdGetLength(itemid);
+		tuple.t_tableOid = RelationGetRelid(node->ss.ss_currentRelation);
+		ItemPointerSet(&tuple.t_self, blockno, off);
+
+		if (!sample_visible(scan, &tuple, off))
+			continue;
+
+		value = heap_getattr(&tuple, st->attnum, tupdesc, &isnull);
+		if (!isnull && sample_keep(st, value)) {
+			st->lt = off;
+			return off;
+		}
+	}
+
+	st->lt = InvalidOffsetNumber;
+	return InvalidOffsetNumber;
+}
+
+/* hashlib(internal) returns tsm_handler */
+Datum
+pg_hashlib_tsm_handler(PG_FUNCTION_ARGS)
+{
+	TsmRoutine *tsm = makeNode(TsmRoutine);
+
+	tsm->parameterTypes = list_make3_oid(TEXTOID, FLOAT4OID, TEXTOID);
+	tsm->repeatable_across_queries = true;
+	tsm->repeatable_across_scans = true;
+	tsm->SampleScanGetSampleSize = sample_getsamplesize;
+	tsm->InitSampleScan = sample_init;
+	tsm->BeginSampleScan = sample_begin;
+	tsm->NextSampleBlock = NULL;
+	tsm->NextSampleTuple = sample_nexttuple;
+	tsm->EndSampleScan = NULL;
+
+	PG_RETURN_POINTER(tsm);
+}
+
+#endif
@@ -0,0 +1,478 @@
+/*
+ * Shard routing.
+ *
+ * Jump consistent hash, from "A Fast, Minimal Memory, Consistent Hash
+ * Algorithm" by John Lamping and Eric Veach.  When number of buckets
+ * changes from N to N+1, only 1/(N+1) of keys move, all into new bucket.
+ *
+ * Rendezvous hashing gives each node score for key and picks node with
+ * highest score.  Removing node moves only keys that were on it.
+ * Node names are hashed once per call site, score is integer mix
+ * of key hash and node hash, so call does one string hash.
+ *
+ * Hash to bucket uses Lemire's multiply-shift reduction, bucket is
+ * high half of hash times number of buckets.  No division and no
+ * modulo bias, hash must have full range of its width.
+ */
+
+#include "pghashlib.h"
+
+#if PG_VERSION_NUM >= 90600
+
+#include <math.h>
+
+#include "access/htup_details.h"
+#include "catalog/pg_type.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "utils/array.h"
+#include "utils/builtins.h"
+#include "utils/memutils.h"
+
+PG_FUNCTION_INFO_V1(pg_jump_hash);
+PG_FUNCTION_INFO_V1(pg_jump_hash_string);
+PG_FUNCTION_INFO_V1(pg_jump_hash_moves);
+PG_FUNCTION_INFO_V1(pg_rendezvous_pick);
+PG_FUNCTION_INFO_V1(pg_rendezvous_top);
+PG_FUNCTION_INFO_V1(pg_hash_bucket);
+PG_FUNCTION_INFO_V1(pg_hash_int_bucket);
+
+static void
+check_buckets(int32 nbuckets)
+{
+	if (nbuckets < 1)
+		elog(ERROR, "number of buckets must be positive");
+}
+
+static int32
+jump_consistent_hash(uint64_t key, int32 nbuckets)
+{
+	int64 b = -1, j = 0;
+
+	while (j < nbuckets) {
+		b = j;
+		key = key * 2862933555777941757ULL + 1;
+		j = (b + 1) * ((double) (1LL << 31) / (double) ((key >> 33) + 1));
+	}
+	return b;
+}
+
+/* jump_hash(int8, int4) returns int4 */
+Datum
+pg_jump_hash(PG_FUNCTION_ARGS)
+{
+	int32 nbuckets = PG_GETARG_INT32(1);
+
+	check_buckets(nbuckets);
+	PG_RETURN_INT32(jump_consistent_hash(PG_GETARG_INT64(0), nbuckets));
+}
+
+/* jump_hash_string(bytea, text, int4) returns int4 */
+Datum
+pg_jump_hash_string(PG_FUNCTION_ARGS)
+{
+	int32 nbuckets = PG_GETARG_INT32(2);
+	const struct StrHashDesc *desc;
+	uint64_t io[MAX_IO_VALUES];
+
+	check_buckets(nbuckets);
+	desc = hlib_load_string_hash(fcinfo, PG_GETARG_TEXT_PP(1));
+
+	/* same as hash64_string(data, algo) */
+	memset(io, 0, sizeof(io));
+	io[0] = desc->initval;
+	hlib_hash_varlena(desc->hash, desc->stream, PG_GETARG_DATUM(0), io);
+
+	PG_RETURN_INT32(jump_consistent_hash(io[0], nbuckets));
+}
+
+/* (hash * nbuckets) >> bits, without 128-bit arithmetic */
+static int32
+reduce_range(uint64_t hash, int bits, int32 nbuckets)
+{
+	uint64_t n = nbuckets;
+
+	if (bits <= 32)
+		return ((hash & 0xFFFFFFFF) * n) >> 32;
+
+	/* both partial products fit into 64 bits as nbuckets < 2^31 */
+	return ((hash >> 32) * n + (((hash & 0xFFFFFFFF) * n) >> 32)) >> 32;
+}
+
+/* hash_bucket(bytea, text, int4) returns int4 */
+Datum
+pg_hash_bucket(PG_FUNCTION_ARGS)
+{
+	int32 nbuckets = PG_GETARG_INT32(2);
+	const struct StrHashDesc *desc;
+	uint64_t io[MAX_IO_VALUES];
+
+	check_buckets(nbuckets);
+	desc = hlib_load_string_hash(fcinfo, PG_GETARG_TEXT_PP(1));
+
+	/* same as hash64_string(data, algo) */
+	memset(io, 0, sizeof(io));
+	io[0] = desc->initval;
+	hlib_hash_varlena(desc->hash, desc->stream, PG_GETARG_DATUM(0), io);
+
+	PG_RETURN_INT32(reduce_range(io[0], desc->bits, nbuckets));
+}
+
+/*
+ * Integer algorithm can come from either list,
+ * so remember both kinds of descriptor.
+ */
+struct IntBucketCache {
+	const struct Int32HashDesc *desc32;
+	const struct Int64HashDesc *desc64;
+	unsigned namelen;
+	char name[HASHNAMELEN];
+};
+
+/* hash_int_bucket(int8, text, int4) returns int4 */
+Datum
+pg_hash_int_bucket(PG_FUNCTION_ARGS)
+{
+	uint64_t data = PG_GETARG_INT64(0);
+	text *hashname = PG_GETARG_TEXT_PP(1);
+	int32 nbuckets = PG_GETARG_INT32(2);
+	const char *name = VARDATA_ANY(hashname);
+	unsigned nlen = VARSIZE_ANY_EXHDR(hashname);
+	struct IntBucketCache *cache = fcinfo->flinfo->fn_extra;
+
+	check_buckets(nbuckets);
+
+	if (cache == NULL || cache->namelen != nlen || memcmp(cache->name, name, nlen) != 0) {
+		const struct Int64HashDesc *desc64 = hlib_find_int64_hash(name, nlen);
+		const struct Int32HashDesc *desc32 = desc64 ? NULL : hlib_find_int32_hash(name, nlen);
+
+		if (desc64 == NULL && desc32 == NULL)
+			elog(ERROR, "hash '%s' not found", text_to_cstring(hashname));
+		if (cache == NULL) {
+			cache = MemoryContextAlloc(fcinfo->flinfo->fn_mcxt, sizeof(*cache));
+			fcinfo->flinfo->fn_extra = cache;
+		}
+		cache->desc32 = desc32;
+		cache->desc64 = desc64;
+		cache->namelen = nlen;
+		memcpy(cache->name, name, nlen);
+	}
+
+	/* same as hash_int8(data, algo) or hash_int4(data, algo) */
+	if (cache->desc64)
+		PG_RETURN_INT32(reduce_range(cache->desc64->hash(data), cache->desc64->bits, nbuckets));
+	data = ((data >> 32) ^ data) & 0xFFFFFFFF;
+	PG_RETURN_INT32(reduce_range(cache->desc32->hash(data), 32, nbuckets));
+}
+
+struct MovesState {
+	int64 next;
+	int64 last;
+	bool done;
+};
+
+/* jump_hash_moves(int8, int8, int4, int4) returns setof record(key int8, old_bucket int4, new_bucket int4) */
+Datum
+pg_jump_hash_moves(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	struct MovesState *st;
+	int32 oldn = PG_GETARG_INT32(2);
+	int32 newn = PG_GETARG_INT32(3);
+	int32 b1, b2;
+	int64 key;
+	Datum values[3];
+	bool nulls[3] = { false, false, false };
+	HeapTuple tuple;
+
+	if (SRF_IS_FIRSTCALL()) {
+		MemoryContext oldctx;
+		TupleDesc tupdesc;
+
+		check_buckets(oldn);
+		check_buckets(newn);
+
+		funcctx = SRF_FIRSTCALL_INIT();
+		oldctx = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+			elog(ERROR, "return type must be a row type");
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+		st = palloc(sizeof(*st));
+		st->next = PG_GETARG_INT64(0);
+		st->last = PG_GETARG_INT64(1);
+		st->done = st->next > st->last;
+		funcctx->user_fctx = st;
+		MemoryContextSwitchTo(oldctx);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	st = funcctx->user_fctx;
+
+	/* scan until next moving key */
+	while (!st->done) {
+		key = st->next;
+		if (key == st->last)
+			st->done = true;
+		else
+			st->next++;
+
+		if ((key & 0xFFFF) == 0)
+			CHECK_FOR_INTERRUPTS();
+
+		b1 = jump_consistent_hash(key, oldn);
+		b2 = jump_consistent_hash(key, newn);
+		if (b1 == b2)
+			continue;
+
+		values[0] = Int64GetDatum(key);
+		values[1] = Int32GetDatum(b1);
+		values[2] = Int32GetDatum(b2);
+		tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+		SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+	}
+	SRF_RETURN_DONE(funcctx);
+}
+
+/*
+ * Rendezvous hashing.
+ */
+
+/* per-call-site cache in fn_extra */
+struct RendezvousCache {
+	const struct StrHashDesc *desc;
+	unsigned namelen;
+	char name[HASHNAMELEN];
+	MemoryContext nodecxt;
+
+	/* copies of arguments that seeds were calculated from */
+	ArrayType *nodes;
+	ArrayType *weights;
+
+	int nnodes;		/* 0 if not loaded */
+	Datum *names;
+	uint64_t *seeds;
+	double *wvals;		/* NULL if not weighted */
+	double *scores;		/* scratch space for top-k */
+};
+
+static bool
+same_array(ArrayType *a, ArrayType *b)
+{
+	if (a == NULL || b == NULL)
+		return a == b;
+	return VARSIZE(a) == VARSIZE(b) && memcmp(a, b, VARSIZE(a)) == 0;
+}
+
+static ArrayType *
+copy_array(ArrayType *arr)
+{
+	ArrayType *res = palloc(VARSIZE(arr));
+
+	memcpy(res, arr, VARSIZE(arr));
+	return res;
+}
+
+/* calculate node seeds, cache is marked loaded only when all is valid */
+static void
+load_nodes(struct RendezvousCache *cache, ArrayType *nodes, ArrayType *weights)
+{
+	MemoryContext oldctx;
+	uint64_t io[MAX_IO_VALUES];
+	Datum *wdatums;
+	bool *nulls, *wnulls;
+	int n, nw, i;
+	bool any = false;
+
+	cache->nnodes = 0;
+	MemoryContextReset(cache->nodecxt);
+	oldctx = MemoryContextSwitchTo(cache->nodecxt);
+
+	if (ARR_NDIM(nodes) > 1 || (weights && ARR_NDIM(weights) > 1))
+		elog(ERROR, "nodes and weights must be one-dimensional arrays");
+
+	/* names point into cached copy */
+	cache->nodes = copy_array(nodes);
+	deconstruct_array(cache->nodes, TEXTOID, -1, false, 'i', &cache->names, &nulls, &n);
+	if (n == 0)
+		elog(ERROR, "nodes must not be empty");
+
+	cache->seeds = palloc(n * sizeof(uint64_t));
+	cache->scores = palloc(n * sizeof(double));
+	for (i = 0; i < n; i++) {
+		if (nulls[i])
+			elog(ERROR, "node names must not be NULL");
+
+		/* same as hash64_string(node, algo), unpacks short headers for alignment */
+		memset(io, 0, sizeof(io));
+		io[0] = cache->desc->initval;
+		hlib_hash_varlena(cache->desc->hash, cache->desc->stream, cache->names[i], io);
+		cache->seeds[i] = io[0];
+	}
+
+	cache->weights = NULL;
+	cache->wvals = NULL;
+	if (weights) {
+		cache->weights = copy_array(weights);
+		deconstruct_array(weights, FLOAT8OID, 8, FLOAT8PASSBYVAL, 'd', &wdatums, &wnulls, &nw);
+		if (nw != n)
+			elog(ERROR, "weights must have same length as nodes");
+		cache->wvals = palloc(n * sizeof(double));
+		for (i = 0; i < n; i++) {
+			double w = wnulls[i] ? -1 : DatumGetFloat8(wdatums[i]);
+
+			if (!(w >= 0 && w < HUGE_VAL))
+				elog(ERROR, "weights must be non-negative numbers");
+			cache->wvals[i] = w;
+			any |= (w > 0);
+		}
+		if (!any)
+			elog(ERROR, "at least one weight must be positive");
+	}
+
+	MemoryContextSwitchTo(oldctx);
+	cache->nnodes = n;
+}
+
+static struct RendezvousCache *
+load_cache(FunctionCallInfo fcinfo, text *hashname, ArrayType *nodes, ArrayType *weights)
+{
+	struct RendezvousCache *cache = fcinfo->flinfo->fn_extra;
+	const char *name = VARDATA_ANY(hashname);
+	unsigned nlen = VARSIZE_ANY_EXHDR(hashname);
+
+	if (cache == NULL) {
+		cache = MemoryContextAllocZero(fcinfo->flinfo->fn_mcxt, sizeof(*cache));
+		cache->nodecxt = AllocSetContextCreate(fcinfo->flinfo->fn_mcxt, "rendezvous nodes",
+						       ALLOCSET_SMALL_SIZES);
+		fcinfo->flinfo->fn_extra = cache;
+	}
+
+	if (cache->desc == NULL || cache->namelen != nlen || memcmp(cache->name, name, nlen) != 0) {
+		cache->nnodes = 0;
+		cache->desc = hlib_find_string_hash(name, nlen);
+		if (cache->desc == NULL)
+			elog(ERROR, "hash '%s' not found", text_to_cstring(hashname));
+		cache->namelen = nlen;
+		memcpy(cache->name, name, nlen);
+	}
+
+	/* usually nodes are constant, so seeds are calculated once */
+	if (cache->nnodes == 0 || !same_array(cache->nodes, nodes) || !same_array(cache->weights, weights))
+		load_nodes(cache, nodes, weights);
+	return cache;
+}
+
+/*
+ * Score of node for key.  Unweighted score is uniform 53-bit integer,
+ * weighted score is -w / ln(u), where u is same integer mapped into (0, 1).
+ * Nodes with zero weight get negative score.
+ */
+static double
+node_score(const struct RendezvousCache *cache, int i, uint64_t keyhash)
+{
+	uint64_t mix = hlib_int64_wang(keyhash ^ cache->seeds[i]);
+	double u;
+
+	if (cache->wvals == NULL)
+		return (double) (mix >> 11);
+	if (cache->wvals[i] == 0)
+		return -1;
+	u = ((mix >> 11) + 0.5) / 9007199254740992.0;
+	return -cache->wvals[i] / log(u);
+}
+
+/* load cache and hash key, NULL if arguments are NULL */
+static struct RendezvousCache *
+rendezvous_load(FunctionCallInfo fcinfo, int weights_arg, int algo_arg, uint64_t *keyhash)
+{
+	struct RendezvousCache *cache;
+	ArrayType *weights = NULL;
+	uint64_t io[MAX_IO_VALUES];
+
+	if (PG_ARGISNULL(0) || PG_ARGISNULL(1) || PG_ARGISNULL(algo_arg))
+		return NULL;
+	if (weights_arg >= 0 && !PG_ARGISNULL(weights_arg))
+		weights = PG_GETARG_ARRAYTYPE_P(weights_arg);
+	cache = load_cache(fcinfo, PG_GETARG_TEXT_PP(algo_arg), PG_GETARG_ARRAYTYPE_P(1), weights);
+
+	/* same as hash64_string(key, algo) */
+	memset(io, 0, sizeof(io));
+	io[0] = cache->desc->initval;
+	hlib_hash_varlena(cache->desc->hash, cache->desc->stream, PG_GETARG_DATUM(0), io);
+	*keyhash = io[0];
+	return cache;
+}
+
+/* rendezvous_pick(bytea, text[] [, float8[]], text) returns text */
+Datum
+pg_rendezvous_pick(PG_FUNCTION_ARGS)
+{
+	struct RendezvousCache *cache;
+	uint64_t keyhash;
+	double score, best = -1;
+	int i, besti = 0;
+
+	if (PG_NARGS() >= 4)
+		cache = rendezvous_load(fcinfo, 2, 3, &keyhash);
+	else
+		cache = rendezvous_load(fcinfo, -1, 2, &keyhash);
+	if (cache == NULL)
+		PG_RETURN_NULL();
+
+	for (i = 0; i < cache->nnodes; i++) {
+		score = node_score(cache, i, keyhash);
+		if (score > best) {
+			best = score;
+			besti = i;
+		}
+	}
+	PG_RETURN_TEXT_P(DatumGetTextPCopy(cache->names[besti]));
+}
+
+/* rendezvous_top(bytea, text[] [, float8[]], int4, text) returns text[] */
+Datum
+pg_rendezvous_top(PG_FUNCTION_ARGS)
+{
+	struct RendezvousCache *cache;
+	uint64_t keyhash;
+	int k_arg = PG_NARGS() - 2;
+	double *scores;
+	Datum *res;
+	int k, n, i, besti;
+
+	if (PG_ARGISNULL(k_arg))
+		PG_RETURN_NULL();
+	k = PG_GETARG_INT32(k_arg);
+	if (k < 1)
+		elog(ERROR, "number of nodes to pick must be positive");
+
+	if (PG_NARGS() >= 5)
+		cache = rendezvous_load(fcinfo, 2, 4, &keyhash);
+	else
+		cache = rendezvous_load(fcinfo, -1, 3, &keyhash);
+	if (cache == NULL)
+		PG_RETURN_NULL();
+
+	scores = cache->scores;
+	for (i = 0; i < cache->nnodes; i++)
+		scores[i] = node_score(cache, i, keyhash);
+
+	/* repeated selection of best, k is usually small */
+	res = palloc(Min(k, cache->nnodes) * sizeof(Datum));
+	for (n = 0; n < k && n < cache->nnodes; n++) {
+		besti = -1;
+		for (i = 0; i < cache->nnodes; i++) {
+			if (scores[i] >= 0 && (besti < 0 || scores[i] > scores[besti]))
+				besti = i;
+		}
+		if (besti < 0)
+			break;
+		res[n] = cache->names[besti];
+		scores[besti] = -1;
+	}
+	PG_RETURN_ARRAYTYPE_P(construct_array(res, n, TEXTOID, -1, false, 'i'));
+}
+
+#endif
@@ -0,0 +1,360 @@
+/*
+ * Hashing of data that does not fit into memory.
+ *
+ * Data is fed in fixed-size pieces into incremental hash,
+ * so memory use does not depend on data size.
+ */
+
+#include "pghashlib.h"
+
+#if PG_VERSION_NUM >= 90600
+
+#include "libpq/be-fsstubs.h"
+#include "libpq/libpq-fs.h"
+#include "miscadmin.h"
+#include "storage/large_object.h"
+#include "utils/builtins.h"
+
+#if PG_VERSION_NUM >= 130000
+#include "access/detoast.h"
+#include "access/heaptoast.h"
+#else
+#include "access/tuptoaster.h"
+#define detoast_external_attr heap_tuple_fetch_attr
+#endif
+#if PG_VERSION_NUM >= 140000
+#include "access/toast_compression.h"
+#endif
+
+/* backend renamed fmgr entry points to avoid clash with libpq */
+#if PG_VERSION_NUM >= 110000
+#define hlib_lo_open	be_lo_open
+#define hlib_lo_close	be_lo_close
+#else
+#define hlib_lo_open	lo_open
+#define hlib_lo_close	lo_close
+#endif
+
+/* read size for large objects, multiple of pg_largeobject page size */
+#define LO_READ_SIZE	(32 * LOBLKSIZE)
+
+/* values smaller than that are simply detoasted */
+#define TOAST_STREAM_MIN	(1024 * 1024)
+
+/* fetch size for external values, multiple of toast chunk size */
+#define TOAST_SLICE_SIZE	(64 * TOAST_MAX_CHUNK_SIZE)
+
+/* header size of compressed inline value */
+#define COMPRESSED_HDRSZ	offsetof(varattrib_4b, va_compressed.va_data)
+
+/* pglz format limits */
+#define PGLZ_HISTORY		4096
+#define PGLZ_MAX_MATCH		273
+#define PGLZ_OUT_SIZE		(64 * 1024)
+
+PG_FUNCTION_INFO_V1(pg_hash_lo);
+PG_FUNCTION_INFO_V1(pg_hash64_lo);
+PG_FUNCTION_INFO_V1(pg_hash128_lo);
+
+/* load hash that supports incremental hashing */
+static const struct StrHashDesc *
+load_stream_hash(FunctionCallInfo fcinfo, text *hashname)
+{
+	const struct StrHashDesc *desc;
+
+	desc = hlib_load_string_hash(fcinfo, hashname);
+	if (desc->stream == NULL)
+		elog(ERROR, "hash '%s' does not support incremental hashing",
+		     text_to_cstring(hashname));
+	return desc;
+}
+
+/* decide initvals, same rules as for string functions */
+static void
+load_initvals(FunctionCallInfo fcinfo, int bits, const struct StrHashDesc *desc, uint64_t *io)
+{
+	memset(io, 0, sizeof(uint64_t) * MAX_IO_VALUES);
+	if (bits == 32) {
+		io[0] = (PG_NARGS() >= 3) ? (uint64_t)PG_GETARG_INT32(2) : desc->initval;
+	} else if (bits == 64) {
+		io[0] = (PG_NARGS() >= 3) ? (uint64_t)PG_GETARG_INT64(2) : desc->initval;
+		if (PG_NARGS() >= 4)
+			io[1] = PG_GETARG_INT64(3);
+	} else {
+		if (PG_NARGS() >= 3)
+			io[0] = PG_GETARG_INT64(2);
+		if (PG_NARGS() >= 4)
+			io[1] = PG_GETARG_INT64(3);
+	}
+}
+
+static Datum
+make_hash128(uint64_t *io)
+{
+	bytea *res;
+
+	/* always output little-endian */
+	io[0] = htole64(io[0]);
+	io[1] = htole64(io[1]);
+
+	res = palloc(VARHDRSZ + 16);
+	SET_VARSIZE(res, VARHDRSZ + 16);
+	memcpy(VARDATA(res), io, 16);
+	PG_RETURN_BYTEA_P(res);
+}
+
+/*
+ * TOAST values.
+ *
+ * External uncompressed values are fetched in slices, pglz-compressed
+ * values are decompressed into small window that is hashed and reused.
+ * Compressed external value is fetched in compressed form, so memory
+ * use is bounded by compressed size.  Anything else is detoasted
+ * normally.
+ */
+
+static void
+stream_slices(const struct HashStreamOps *ops, void *state, Datum value, Size rawlen)
+{
+	struct varlena *slice;
+	Size pos, n;
+
+	for (pos = 0; pos < rawlen; pos += n) {
+		CHECK_FOR_INTERRUPTS();
+		n = Min(TOAST_SLICE_SIZE, rawlen - pos);
+		slice = PG_DETOAST_DATUM_SLICE(value, pos, n);
+		if (VARSIZE_ANY_EXHDR(slice) != n)
+			elog(ERROR, "unexpected toast slice size");
+		ops->update(state, VARDATA_ANY(slice), n);
+		pfree(slice);
+	}
+}
+
+static void
+pglz_corrupt(void)
+{
+	elog(ERROR, "compressed data is corrupt");
+}
+
+/*
+ * Decompress pglz data, feeding output into hash.
+ *
+ * Keeps last PGLZ_HISTORY bytes of output for back-references,
+ * otherwise follows pglz_decompress().
+ */
+static void
+stream_pglz(const struct HashStreamOps *ops, void *state,
+	    const unsigned char *sp, Size srclen, Size rawlen)
+{
+	const unsigned char *srcend = sp + srclen;
+	unsigned char *buf = palloc(PGLZ_HISTORY + PGLZ_OUT_SIZE);
+	unsigned char *bufend = buf + PGLZ_HISTORY + PGLZ_OUT_SIZE;
+	unsigned char *dp = buf;
+	unsigned char *flushed = buf;
+	Size dropped = 0;
+	unsigned char ctrl;
+	int bit, len, off;
+
+#define PRODUCED() (dropped + (dp - buf))
+
+	while (sp < srcend && PRODUCED() < rawlen) {
+		ctrl = *sp++;
+		for (bit = 0; bit < 8 && sp < srcend && PRODUCED() < rawlen; bit++, ctrl >>= 1) {
+			/* make room for longest match, keep history */
+			if (bufend - dp < PGLZ_MAX_MATCH) {
+				ops->update(state, flushed, dp - flushed);
+				dropped += (dp - buf) - PGLZ_HISTORY;
+				memmove(buf, dp - PGLZ_HISTORY, PGLZ_HISTORY);
+				dp = flushed = buf + PGLZ_HISTORY;
+				CHECK_FOR_INTERRUPTS();
+			}
+
+			if (ctrl & 1) {
+				/* back-reference: 4-bit length, 12-bit offset, optional extra length */
+				if (srcend - sp < 2)
+					pglz_corrupt();
+				len = (sp[0] & 0x0f) + 3;
+				off = ((sp[0] & 0xf0) << 4) | sp[1];
+				sp += 2;
+				if (len == 18) {
+					if (sp >= srcend)
+						pglz_corrupt();
+					len += *sp++;
+				}
+				if (off == 0 || off > dp - buf)
+					pglz_corrupt();
+				len = Min((Size)len, rawlen - PRODUCED());
+
+				/* may overlap, copy bytewise */
+				while (len-- > 0) {
+					*dp = dp[-off];
+					dp++;
+				}
+			} else {
+				*dp++ = *sp++;
+			}
+		}
+	}
+
+	if (PRODUCED() != rawlen || sp != srcend)
+		pglz_corrupt();
+#undef PRODUCED
+
+	ops->update(state, flushed, dp - flushed);
+	pfree(buf);
+}
+
+static bool
+is_pglz(struct varlena *attr)
+{
+#if PG_VERSION_NUM >= 140000
+	return VARDATA_COMPRESSED_GET_COMPRESS_METHOD(attr) == TOAST_PGLZ_COMPRESSION_ID;
+#else
+	return true;
+#endif
+}
+
+/* is value big external or compressed value */
+static bool
+toast_streamable(Datum value)
+{
+	struct varlena *attr = (struct varlena *) DatumGetPointer(value);
+
+	if (!VARATT_IS_EXTERNAL_ONDISK(attr) && !VARATT_IS_COMPRESSED(attr))
+		return false;
+	return toast_raw_datum_size(value) - VARHDRSZ >= TOAST_STREAM_MIN;
+}
+
+/* feed big toasted value into stream, false if value should be detoasted normally */
+bool
+hlib_stream_toasted(const struct HashStreamOps *ops, void *state, Datum value)
+{
+	struct varlena *attr = (struct varlena *) DatumGetPointer(value);
+	struct varlena *cmp;
+	struct varlena *data;
+	Size rawlen;
+
+	if (ops == NULL || !toast_streamable(value))
+		return false;
+	rawlen = toast_raw_datum_size(value) - VARHDRSZ;
+
+	if (VARATT_IS_EXTERNAL_ONDISK(attr)) {
+		struct varatt_external toast_pointer;
+
+		VARATT_EXTERNAL_GET_POINTER(toast_pointer, attr);
+		if (!VARATT_EXTERNAL_IS_COMPRESSED(toast_pointer)) {
+			stream_slices(ops, state, value, rawlen);
+			return true;
+		}
+		cmp = detoast_external_attr(attr);
+	} else {
+		cmp = attr;
+	}
+
+	if (is_pglz(cmp)) {
+		stream_pglz(ops, state, (unsigned char *) cmp + COMPRESSED_HDRSZ,
+			    VARSIZE(cmp) - COMPRESSED_HDRSZ, rawlen);
+	} else {
+		data = PG_DETOAST_DATUM(PointerGetDatum(cmp));
+		ops->update(state, VARDATA(data), VARSIZE(data) - VARHDRSZ);
+		pfree(data);
+	}
+
+	if (cmp != attr)
+		pfree(cmp);
+	return true;
+}
+
+/* hash big toasted value in one go, false if value should be detoasted normally */
+bool
+hlib_hash_toasted(const struct HashStreamOps *ops, Datum value, uint64_t *io)
+{
+	void *state;
+
+	if (ops == NULL || !toast_streamable(value))
+		return false;
+
+	state = palloc(ops->state_size);
+	ops->init(state, io);
+	hlib_stream_toasted(ops, state, value);
+	ops->final(state, io);
+	pfree(state);
+	return true;
+}
+
+/*
+ * Large objects.
+ *
+ * Read via backend descriptor, so permission checks and
+ * end-of-transaction cleanup work same way as for lo_get().
+ */
+
+static void
+hash_lo(FunctionCallInfo fcinfo, int bits, uint64_t *io)
+{
+	Oid loid = PG_GETARG_OID(0);
+	const struct StrHashDesc *desc;
+	const struct HashStreamOps *ops;
+	void *state;
+	char *buf;
+	int32 fd;
+	int n;
+
+	desc = load_stream_hash(fcinfo, PG_GETARG_TEXT_PP(1));
+	ops = desc->stream;
+	load_initvals(fcinfo, bits, desc, io);
+
+	state = palloc(ops->state_size);
+	buf = palloc(LO_READ_SIZE);
+
+	fd = DatumGetInt32(DirectFunctionCall2(hlib_lo_open,
+					       ObjectIdGetDatum(loid),
+					       Int32GetDatum(INV_READ)));
+
+	ops->init(state, io);
+	while (1) {
+		CHECK_FOR_INTERRUPTS();
+		n = lo_read(fd, buf, LO_READ_SIZE);
+		if (n <= 0)
+			break;
+		ops->update(state, buf, n);
+	}
+	ops->final(state, io);
+
+	DirectFunctionCall1(hlib_lo_close, Int32GetDatum(fd));
+
+	pfree(buf);
+	pfree(state);
+}
+
+/* hash_lo(oid, text [, int4]) returns int4 */
+Datum
+pg_hash_lo(PG_FUNCTION_ARGS)
+{
+	uint64_t io[MAX_IO_VALUES];
+
+	hash_lo(fcinfo, 32, io);
+	PG_RETURN_INT32(io[0]);
+}
+
+/* hash64_lo(oid, text [, int8 [, int8]]) returns int8 */
+Datum
+pg_hash64_lo(PG_FUNCTION_ARGS)
+{
+	uint64_t io[MAX_IO_VALUES];
+
+	hash_lo(fcinfo, 64, io);
+	PG_RETURN_INT64(io[0]);
+}
+
+/* hash128_lo(oid, text [, int8 [, int8]]) returns bytea */
+Datum
+pg_hash128_lo(PG_FUNCTION_ARGS)
+{
+	uint64_t io[MAX_IO_VALUES];
+
+	hash_lo(fcinfo, 128, io);
+	return make_hash128(io);
+}
+
+#endif
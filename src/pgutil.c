@@ -0,0 +1,94 @@
+/*
+ * Helpers shared by aggregates and sketch types.
+ */
+
+#include "pghashlib.h"
+
+#if PG_VERSION_NUM >= 90600
+
+#include "libpq/pqformat.h"
+#include "utils/builtins.h"
+
+/*
+ * Aggregate support.
+ */
+
+MemoryContext
+hlib_agg_context(FunctionCallInfo fcinfo, const char *fname)
+{
+	MemoryContext aggctx;
+
+	if (!AggCheckCallContext(fcinfo, &aggctx))
+		elog(ERROR, "%s called in non-aggregate context", fname);
+	return aggctx;
+}
+
+/*
+ * Little-endian integers in binary formats.
+ */
+
+void
+hlib_put_le32(StringInfo buf, uint32 val)
+{
+	uint32 tmp = htole32(val);
+
+	appendBinaryStringInfo(buf, (char *) &tmp, 4);
+}
+
+void
+hlib_put_le64(StringInfo buf, uint64 val)
+{
+	uint64 tmp = htole64(val);
+
+	appendBinaryStringInfo(buf, (char *) &tmp, 8);
+}
+
+uint32
+hlib_get_le32(StringInfo buf)
+{
+	uint32 tmp;
+
+	pq_copymsgbytes(buf, (char *) &tmp, 4);
+	return le32toh(tmp);
+}
+
+uint64
+hlib_get_le64(StringInfo buf)
+{
+	uint64 tmp;
+
+	pq_copymsgbytes(buf, (char *) &tmp, 8);
+	return le64toh(tmp);
+}
+
+/*
+ * Text I/O of binary types, hex with \x prefix like bytea.
+ */
+
+bytea *
+hlib_hex_in(const char *str, const char *what)
+{
+	size_t len = strlen(str);
+	bytea *res;
+
+	if (len < 2 || str[0] != '\\' || str[1] != 'x' || len % 2 != 0)
+		elog(ERROR, "invalid %s: expected hex string starting with \\x", what);
+
+	res = palloc(VARHDRSZ + (len - 2) / 2);
+	SET_VARSIZE(res, VARHDRSZ + hex_decode(str + 2, len - 2, VARDATA(res)));
+	return res;
+}
+
+char *
+hlib_hex_out(const char *data, size_t len)
+{
+	char *res;
+
+	res = palloc(len * 2 + 3);
+	res[0] = '\\';
+	res[1] = 'x';
+	res[2 + hex_encode(data, len, res + 2)] = 0;
+	return res;
+}
+
+#endif
@@ -34,6 +34,7 @@ static inline uint64_t sip_le64dec(const void *p)
     v0 += v3; v3 = rol64(v3, 21); v3 ^= v0;			\
     v2 += v1; v1 = rol64(v1, 17); v1 ^= v2; v2 = rol64(v2, 32)
 #define SIP_ROUND2	SIP_ROUND1; SIP_ROUND1
+#define SIP_ROUND3	SIP_ROUND2; SIP_ROUND1
 #define SIP_ROUND4	SIP_ROUND2; SIP_ROUND2
 #define SIP_ROUNDS(n)	SIP_ROUND ## n
 
@@ -50,22 +51,19 @@ static inline uint64_t sip_le64dec(const void *p)
 		SIP_ROUNDS(n);	\
 	} while (0)
 
-static uint64_t siphash24(const void *data, size_t len, uint64_t k0, uint64_t k1)
+#define sip_init(k0, k1)					\
+	do {							\
+		v0 = (k0) ^ UINT64_C(0x736f6d6570736575);	\
+		v1 = (k1) ^ UINT64_C(0x646f72616e646f6d);	\
+		v2 = (k0) ^ UINT64_C(0x6c7967656e657261);	\
+		v3 = (k1) ^ UINT64_C(0x7465646279746573);	\
+	} while (0)
+
+/* last block: tail bytes and total length */
+static inline uint64_t sip_tail(const uint8_t *s, uint64_t len)
 {
-	const uint8_t *s = data;
-	const uint8_t *end = s + len - (len % 8);
-	uint64_t v0 = k0 ^ UINT64_C(0x736f6d6570736575);
-	uint64_t v1 = k1 ^ UINT64_C(0x646f72616e646f6d);
-	uint64_t v2 = k0 ^ UINT64_C(0x6c7967656e657261);
-	uint64_t v3 = k1 ^ UINT64_C(0x7465646279746573);
-	uint64_t m;
-
-	for (; s < end; s += 8) {
-		m = sip_le64dec(s);
-		sip_compress(2);
-	}
+	uint64_t m = len << 56;
 
-	m = (uint64_t)len << 56;
 	switch (len & 7) {
 	case 7: m |= (uint64_t)s[6] << 48;
 	case 6: m |= (uint64_t)s[5] << 40;
@@ -76,8 +74,28 @@ static uint64_t siphash24(const void *data, size_t len, uint64_t k0, uint64_t k1
 	case 1: m |= (uint64_t)s[0]; break;
 	case 0: break;
 	}
-	sip_compress(2);
+	return m;
+}
+
+/* all blocks with n compression rounds */
+#define sip_blocks(n)					\
+	do {						\
+		const uint8_t *end = s + len - (len % 8);	\
+		for (; s < end; s += 8) {		\
+			m = sip_le64dec(s);		\
+			sip_compress(n);		\
+		}					\
+		m = sip_tail(s, len);			\
+		sip_compress(n);			\
+	} while (0)
 
+static uint64_t siphash24(const void *data, size_t len, uint64_t k0, uint64_t k1)
+{
+	const uint8_t *s = data;
+	uint64_t v0, v1, v2, v3, m;
+
+	sip_init(k0, k1);
+	sip_blocks(2);
 	sip_finalize(4);
 	return (v0 ^ v1 ^ v2 ^ v3);
 }
@@ -87,3 +105,193 @@ void hlib_siphash24(const void *data, size_t len, uint64_t *io)
 	io[0] = siphash24(data, len, io[0], io[1]);
 }
 
+/* SipHash-1-3, fewer rounds, as used in Rust and Python */
+static uint64_t siphash13(const void *data, size_t len, uint64_t k0, uint64_t k1)
+{
+	const uint8_t *s = data;
+	uint64_t v0, v1, v2, v3, m;
+
+	sip_init(k0, k1);
+	sip_blocks(1);
+	sip_finalize(3);
+	return (v0 ^ v1 ^ v2 ^ v3);
+}
+
+void hlib_siphash13(const void *data, size_t len, uint64_t *io)
+{
+	io[0] = siphash13(data, len, io[0], io[1]);
+}
+
+/* SipHash-2-4 with 128-bit output, result in io[0] and io[1] */
+void hlib_siphash24_128(const void *data, size_t len, uint64_t *io)
+{
+	const uint8_t *s = data;
+	uint64_t v0, v1, v2, v3, m;
+
+	sip_init(io[0], io[1]);
+	v1 ^= 0xee;
+	sip_blocks(2);
+
+	v2 ^= 0xee;
+	SIP_ROUNDS(4);
+	io[0] = v0 ^ v1 ^ v2 ^ v3;
+
+	v1 ^= 0xdd;
+	SIP_ROUNDS(4);
+	io[1] = v0 ^ v1 ^ v2 ^ v3;
+}
+
+/*
+ * HalfSipHash-1-3, 32-bit state and output, 64-bit key.
+ * Key is io[0] as little-endian bytes.
+ */
+
+static inline uint32_t rol32(uint32_t v, int s)
+{
+	return (v << s) | (v >> (32 - s));
+}
+
+static inline uint32_t sip_le32dec(const void *p)
+{
+	uint32_t v;
+	memcpy(&v, p, 4);
+	return le32toh(v);
+}
+
+#define HSIP_ROUND1 \
+    v0 += v1; v1 = rol32(v1, 5); v1 ^= v0; v0 = rol32(v0, 16);	\
+    v2 += v3; v3 = rol32(v3, 8); v3 ^= v2;			\
+    v0 += v3; v3 = rol32(v3, 7); v3 ^= v0;			\
+    v2 += v1; v1 = rol32(v1, 13); v1 ^= v2; v2 = rol32(v2, 16)
+#define HSIP_ROUND2	HSIP_ROUND1; HSIP_ROUND1
+#define HSIP_ROUND3	HSIP_ROUND2; HSIP_ROUND1
+#define HSIP_ROUNDS(n)	HSIP_ROUND ## n
+
+static uint32_t halfsiphash13(const void *data, size_t len, uint32_t k0, uint32_t k1)
+{
+	const uint8_t *s = data;
+	const uint8_t *end = s + len - (len % 4);
+	uint32_t v0 = k0;
+	uint32_t v1 = k1;
+	uint32_t v2 = k0 ^ UINT32_C(0x6c796765);
+	uint32_t v3 = k1 ^ UINT32_C(0x74656462);
+	uint32_t m;
+
+	for (; s < end; s += 4) {
+		m = sip_le32dec(s);
+		v3 ^= m;
+		HSIP_ROUNDS(1);
+		v0 ^= m;
+	}
+
+	m = (uint32_t)len << 24;
+	switch (len & 3) {
+	case 3: m |= (uint32_t)s[2] << 16;	/* fall through */
+	case 2: m |= (uint32_t)s[1] <<  8;	/* fall through */
+	case 1: m |= (uint32_t)s[0]; break;
+	case 0: break;
+	}
+	v3 ^= m;
+	HSIP_ROUNDS(1);
+	v0 ^= m;
+
+	v2 ^= 0xff;
+	HSIP_ROUNDS(3);
+	return v1 ^ v3;
+}
+
+void hlib_halfsiphash13(const void *data, size_t len, uint64_t *io)
+{
+	io[0] = halfsiphash13(data, len, (uint32_t)io[0], (uint32_t)(io[0] >> 32));
+}
+
+
+/*
+ * Incremental API.
+ */
+
+struct sip_stream {
+	uint64_t v0, v1, v2, v3;
+	uint64_t len;
+	uint8_t buf[8];
+};
+
+static void sip_stream_init(void *state, const uint64_t *io)
+{
+	struct sip_stream *st = state;
+	uint64_t v0, v1, v2, v3;
+
+	sip_init(io[0], io[1]);
+	st->v0 = v0;
+	st->v1 = v1;
+	st->v2 = v2;
+	st->v3 = v3;
+	st->len = 0;
+}
+
+/* update and final for c compression and d finalization rounds */
+#define SIP_STREAM_FUNCS(name, c, d)						\
+static void name ## _stream_update(void *state, const void *data, size_t len)	\
+{										\
+	struct sip_stream *st = state;						\
+	const uint8_t *s = data;						\
+	const uint8_t *end;							\
+	uint64_t v0 = st->v0, v1 = st->v1, v2 = st->v2, v3 = st->v3;		\
+	uint64_t m;								\
+	unsigned pos = st->len % 8;						\
+	unsigned n;								\
+										\
+	st->len += len;								\
+										\
+	/* fill partial block */						\
+	if (pos > 0) {								\
+		n = 8 - pos;							\
+		if (n > len) {							\
+			memcpy(st->buf + pos, s, len);				\
+			return;							\
+		}								\
+		memcpy(st->buf + pos, s, n);					\
+		s += n;								\
+		len -= n;							\
+		m = sip_le64dec(st->buf);					\
+		sip_compress(c);						\
+	}									\
+										\
+	/* full blocks */							\
+	end = s + len - (len % 8);						\
+	for (; s < end; s += 8) {						\
+		m = sip_le64dec(s);						\
+		sip_compress(c);						\
+	}									\
+										\
+	/* keep tail */								\
+	memcpy(st->buf, s, len % 8);						\
+										\
+	st->v0 = v0;								\
+	st->v1 = v1;								\
+	st->v2 = v2;								\
+	st->v3 = v3;								\
+}										\
+										\
+static void name ## _stream_final(void *state, uint64_t *io)			\
+{										\
+	struct sip_stream *st = state;						\
+	uint64_t v0 = st->v0, v1 = st->v1, v2 = st->v2, v3 = st->v3;		\
+	uint64_t m;								\
+										\
+	m = sip_tail(st->buf, st->len);						\
+	sip_compress(c);							\
+										\
+	sip_finalize(d);							\
+	io[0] = v0 ^ v1 ^ v2 ^ v3;						\
+}										\
+										\
+const struct HashStreamOps hlib_ ## name ## _stream = {				\
+	sizeof(struct sip_stream),						\
+	sip_stream_init,							\
+	name ## _stream_update,							\
+	name ## _stream_final,							\
+};
+
+SIP_STREAM_FUNCS(siphash24, 2, 4)
+SIP_STREAM_FUNCS(siphash13, 1, 3)
@@ -331,3 +331,166 @@ void hlib_spookyhash(const void *message, size_t length, uint64_t *hash)
 	hash[1] = h1;
 }
 
+
+//
+// Incremental API.
+//
+// Data is collected into buffer until there is enough for long mode,
+// short messages are hashed with Short() in final.
+//
+struct spooky_stream {
+	uint64_t data[2 * sc_numVars];	// unhashed data, for partial messages
+	uint64_t state[sc_numVars];	// internal state of the hash
+	size_t length;			// total length of the input so far
+	uint8_t remainder;		// length of unhashed data stashed in data
+};
+
+static void spooky_stream_init(void *state, const uint64_t *io)
+{
+	struct spooky_stream *st = state;
+	st->length = 0;
+	st->remainder = 0;
+	st->state[0] = io[0];
+	st->state[1] = io[1];
+}
+
+static void spooky_stream_update(void *state, const void *message, size_t length)
+{
+	struct spooky_stream *st = state;
+	uint64_t h0, h1, h2, h3, h4, h5, h6, h7, h8, h9, h10, h11;
+	size_t newLength = length + st->remainder;
+	uint8_t remainder;
+	union {
+		const uint8_t *p8;
+		const uint64_t *p64;
+		uintptr_t i;
+	} u;
+	const uint64_t *end;
+
+	// Is this message fragment too short?  If it is, stuff it away.
+	if (newLength < sc_bufSize) {
+		memcpy(&((uint8_t *) st->data)[st->remainder], message, length);
+		st->length = length + st->length;
+		st->remainder = (uint8_t) newLength;
+		return;
+	}
+
+	// init the variables
+	if (st->length < sc_bufSize) {
+		h0 = h3 = h6 = h9 = st->state[0];
+		h1 = h4 = h7 = h10 = st->state[1];
+		h2 = h5 = h8 = h11 = sc_const;
+	} else {
+		h0 = st->state[0];
+		h1 = st->state[1];
+		h2 = st->state[2];
+		h3 = st->state[3];
+		h4 = st->state[4];
+		h5 = st->state[5];
+		h6 = st->state[6];
+		h7 = st->state[7];
+		h8 = st->state[8];
+		h9 = st->state[9];
+		h10 = st->state[10];
+		h11 = st->state[11];
+	}
+	st->length = length + st->length;
+
+	// if we've got anything stuffed away, use it now
+	if (st->remainder) {
+		uint8_t prefix = sc_bufSize - st->remainder;
+		memcpy(&(((uint8_t *) st->data)[st->remainder]), message, prefix);
+		Mix(st->data, h0, h1, h2, h3, h4, h5, h6, h7, h8, h9, h10, h11);
+		Mix(&st->data[sc_numVars], h0, h1, h2, h3, h4, h5, h6, h7, h8, h9, h10, h11);
+		u.p8 = ((const uint8_t *) message) + prefix;
+		length -= prefix;
+	} else {
+		u.p8 = (const uint8_t *) message;
+	}
+
+	// handle all whole blocks of sc_blockSize bytes
+	end = u.p64 + (length / sc_blockSize) * sc_numVars;
+	remainder = (uint8_t) (length - ((const uint8_t *) end - u.p8));
+	if (ALLOW_UNALIGNED_READS || (u.i & 0x7) == 0) {
+		while (u.p64 < end) {
+			Mix(u.p64, h0, h1, h2, h3, h4, h5, h6, h7, h8, h9, h10, h11);
+			u.p64 += sc_numVars;
+		}
+	} else {
+		while (u.p64 < end) {
+			memcpy(st->data, u.p8, sc_blockSize);
+			Mix(st->data, h0, h1, h2, h3, h4, h5, h6, h7, h8, h9, h10, h11);
+			u.p64 += sc_numVars;
+		}
+	}
+
+	// stuff away the last few bytes
+	st->remainder = remainder;
+	memcpy(st->data, end, remainder);
+
+	// stuff away the variables
+	st->state[0] = h0;
+	st->state[1] = h1;
+	st->state[2] = h2;
+	st->state[3] = h3;
+	st->state[4] = h4;
+	st->state[5] = h5;
+	st->state[6] = h6;
+	st->state[7] = h7;
+	st->state[8] = h8;
+	st->state[9] = h9;
+	st->state[10] = h10;
+	st->state[11] = h11;
+}
+
+static void spooky_stream_final(void *state, uint64_t *hash)
+{
+	struct spooky_stream *st = state;
+	uint64_t h0, h1, h2, h3, h4, h5, h6, h7, h8, h9, h10, h11;
+	uint64_t *data = st->data;
+	uint8_t remainder = st->remainder;
+
+	if (st->length < sc_bufSize) {
+		hash[0] = st->state[0];
+		hash[1] = st->state[1];
+		Short(st->data, st->length, hash);
+		return;
+	}
+
+	h0 = st->state[0];
+	h1 = st->state[1];
+	h2 = st->state[2];
+	h3 = st->state[3];
+	h4 = st->state[4];
+	h5 = st->state[5];
+	h6 = st->state[6];
+	h7 = st->state[7];
+	h8 = st->state[8];
+	h9 = st->state[9];
+	h10 = st->state[10];
+	h11 = st->state[11];
+
+	if (remainder >= sc_blockSize) {
+		// data can contain two blocks; handle any whole first block
+		Mix(data, h0, h1, h2, h3, h4, h5, h6, h7, h8, h9, h10, h11);
+		data += sc_numVars;
+		remainder -= sc_blockSize;
+	}
+
+	// mix in the last partial block, and the length mod sc_blockSize
+	memset(&((uint8_t *) data)[remainder], 0, (sc_blockSize - remainder));
+	((uint8_t *) data)[sc_blockSize - 1] = remainder;
+	Mix(data, h0, h1, h2, h3, h4, h5, h6, h7, h8, h9, h10, h11);
+
+	// do some final mixing
+	End(h0, h1, h2, h3, h4, h5, h6, h7, h8, h9, h10, h11);
+	hash[0] = h0;
+	hash[1] = h1;
+}
+
+const struct HashStreamOps hlib_spookyhash_stream = {
+	sizeof(struct spooky_stream),
+	spooky_stream_init,
+	spooky_stream_update,
+	spooky_stream_final,
+};
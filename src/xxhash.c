@@ -0,0 +1,902 @@
+/*
+ * xxHash - XXH64 and XXH3 (64 and 128-bit variants).
+ *
+ * Algorithms by Yann Collet, written here from xxHash specification,
+ * results are same as from reference implementation 0.8.x.
+ *
+ * Long XXH3 inputs are processed in 64-byte stripes, accumulate loop
+ * has SSE2 and AVX2 versions, AVX2 is picked at runtime if CPU has it.
+ */
+
+#include "pghashlib.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define XXH_USE_SSE2
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define XXH_USE_AVX2
+#define XXH_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#define PRIME32_1	UINT32_C(0x9E3779B1)
+#define PRIME32_2	UINT32_C(0x85EBCA77)
+#define PRIME32_3	UINT32_C(0xC2B2AE3D)
+#define PRIME64_1	UINT64_C(0x9E3779B185EBCA87)
+#define PRIME64_2	UINT64_C(0xC2B2AE3D27D4EB4F)
+#define PRIME64_3	UINT64_C(0x165667B19E3779F9)
+#define PRIME64_4	UINT64_C(0x85EBCA77C2B2AE63)
+#define PRIME64_5	UINT64_C(0x27D4EB2F165667C5)
+#define PRIME_MX1	UINT64_C(0x165667919E3779F9)
+#define PRIME_MX2	UINT64_C(0x9FB21C651E98DF25)
+
+static inline uint64_t rotl64(uint64_t v, int s)
+{
+	return (v << s) | (v >> (64 - s));
+}
+
+static inline uint32_t rotl32(uint32_t v, int s)
+{
+	return (v << s) | (v >> (32 - s));
+}
+
+static inline uint32_t xxh_le32dec(const void *p)
+{
+	uint32_t v;
+	memcpy(&v, p, 4);
+	return le32toh(v);
+}
+
+static inline uint64_t xxh_le64dec(const void *p)
+{
+	uint64_t v;
+	memcpy(&v, p, 8);
+	return le64toh(v);
+}
+
+static inline void xxh_le64enc(void *p, uint64_t v)
+{
+	v = htole64(v);
+	memcpy(p, &v, 8);
+}
+
+static inline uint32_t swap32(uint32_t v)
+{
+	return ((v << 24) & 0xff000000) | ((v << 8) & 0x00ff0000)
+		| ((v >> 8) & 0x0000ff00) | ((v >> 24) & 0x000000ff);
+}
+
+static inline uint64_t swap64(uint64_t v)
+{
+	return ((uint64_t)swap32(v) << 32) | swap32(v >> 32);
+}
+
+/* 64x64 -> 128 multiply */
+static inline void mult64to128(uint64_t a, uint64_t b, uint64_t *lo, uint64_t *hi)
+{
+#ifdef __SIZEOF_INT128__
+	unsigned __int128 r = (unsigned __int128)a * b;
+	*lo = (uint64_t)r;
+	*hi = (uint64_t)(r >> 64);
+#else
+	uint64_t lo_lo = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+	uint64_t hi_lo = (a >> 32) * (b & 0xFFFFFFFF);
+	uint64_t lo_hi = (a & 0xFFFFFFFF) * (b >> 32);
+	uint64_t hi_hi = (a >> 32) * (b >> 32);
+	uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+	*hi = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+	*lo = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+#endif
+}
+
+static inline uint64_t mul128_fold64(uint64_t a, uint64_t b)
+{
+	uint64_t lo, hi;
+	mult64to128(a, b, &lo, &hi);
+	return lo ^ hi;
+}
+
+/*
+ * XXH64
+ */
+
+static inline uint64_t xxh64_round(uint64_t acc, uint64_t input)
+{
+	acc += input * PRIME64_2;
+	acc = rotl64(acc, 31);
+	return acc * PRIME64_1;
+}
+
+static inline uint64_t xxh64_merge_round(uint64_t acc, uint64_t val)
+{
+	acc ^= xxh64_round(0, val);
+	return acc * PRIME64_1 + PRIME64_4;
+}
+
+static inline uint64_t xxh64_avalanche(uint64_t h)
+{
+	h ^= h >> 33;
+	h *= PRIME64_2;
+	h ^= h >> 29;
+	h *= PRIME64_3;
+	h ^= h >> 32;
+	return h;
+}
+
+/* tail of less than 32 bytes */
+static uint64_t xxh64_finalize(uint64_t h, const uint8_t *p, size_t len)
+{
+	len &= 31;
+	for (; len >= 8; p += 8, len -= 8) {
+		h ^= xxh64_round(0, xxh_le64dec(p));
+		h = rotl64(h, 27) * PRIME64_1 + PRIME64_4;
+	}
+	if (len >= 4) {
+		h ^= (uint64_t)xxh_le32dec(p) * PRIME64_1;
+		h = rotl64(h, 23) * PRIME64_2 + PRIME64_3;
+		p += 4;
+		len -= 4;
+	}
+	for (; len > 0; p++, len--) {
+		h ^= (*p) * PRIME64_5;
+		h = rotl64(h, 11) * PRIME64_1;
+	}
+	return xxh64_avalanche(h);
+}
+
+static uint64_t xxh64_converge(const uint64_t *v)
+{
+	uint64_t h;
+
+	h = rotl64(v[0], 1) + rotl64(v[1], 7) + rotl64(v[2], 12) + rotl64(v[3], 18);
+	h = xxh64_merge_round(h, v[0]);
+	h = xxh64_merge_round(h, v[1]);
+	h = xxh64_merge_round(h, v[2]);
+	h = xxh64_merge_round(h, v[3]);
+	return h;
+}
+
+static void xxh64_init_lanes(uint64_t *v, uint64_t seed)
+{
+	v[0] = seed + PRIME64_1 + PRIME64_2;
+	v[1] = seed + PRIME64_2;
+	v[2] = seed;
+	v[3] = seed - PRIME64_1;
+}
+
+/* process full 32-byte blocks, returns end of processed data */
+static const uint8_t *xxh64_blocks(uint64_t *v, const uint8_t *p, size_t len)
+{
+	const uint8_t *end = p + len - (len % 32);
+
+	for (; p < end; p += 32) {
+		v[0] = xxh64_round(v[0], xxh_le64dec(p));
+		v[1] = xxh64_round(v[1], xxh_le64dec(p + 8));
+		v[2] = xxh64_round(v[2], xxh_le64dec(p + 16));
+		v[3] = xxh64_round(v[3], xxh_le64dec(p + 24));
+	}
+	return p;
+}
+
+static uint64_t xxh64(const void *data, size_t len, uint64_t seed)
+{
+	const uint8_t *p = data;
+	uint64_t v[4];
+	uint64_t h;
+
+	if (len >= 32) {
+		xxh64_init_lanes(v, seed);
+		p = xxh64_blocks(v, p, len);
+		h = xxh64_converge(v);
+	} else {
+		h = seed + PRIME64_5;
+	}
+	h += len;
+	return xxh64_finalize(h, p, len);
+}
+
+void hlib_xxh64(const void *data, size_t len, uint64_t *io)
+{
+	io[0] = xxh64(data, len, io[0]);
+}
+
+/*
+ * XXH3 - common parts
+ */
+
+#define XXH3_SECRET_SIZE	192
+#define XXH3_SECRET_MIN		136
+#define XXH3_STRIPE_LEN		64
+#define XXH3_CONSUME_RATE	8
+#define XXH3_ACC_NB		8
+#define XXH3_MIDSIZE_MAX	240
+#define XXH3_MIDSIZE_START	3
+#define XXH3_MIDSIZE_LAST	17
+#define XXH3_LASTACC_START	7
+#define XXH3_MERGEACCS_START	11
+
+/* stripes per block with default-size secret */
+#define XXH3_BLOCK_STRIPES	((XXH3_SECRET_SIZE - XXH3_STRIPE_LEN) / XXH3_CONSUME_RATE)
+#define XXH3_SECRET_LIMIT	(XXH3_SECRET_SIZE - XXH3_STRIPE_LEN)
+
+static const uint8_t xxh3_ksecret[XXH3_SECRET_SIZE] = {
+	0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+	0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+	0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+	0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+	0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+	0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+	0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+	0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+	0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+	0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+	0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+	0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+static inline uint64_t xxh3_avalanche(uint64_t h)
+{
+	h ^= h >> 37;
+	h *= PRIME_MX1;
+	h ^= h >> 32;
+	return h;
+}
+
+static inline uint64_t xxh3_rrmxmx(uint64_t h, uint64_t len)
+{
+	h ^= rotl64(h, 49) ^ rotl64(h, 24);
+	h *= PRIME_MX2;
+	h ^= (h >> 35) + len;
+	h *= PRIME_MX2;
+	return h ^ (h >> 28);
+}
+
+static inline uint64_t xxh3_mix16(const uint8_t *p, const uint8_t *secret, uint64_t seed)
+{
+	return mul128_fold64(xxh_le64dec(p) ^ (xxh_le64dec(secret) + seed),
+			     xxh_le64dec(p + 8) ^ (xxh_le64dec(secret + 8) - seed));
+}
+
+/* secret for seeded long inputs */
+static void xxh3_init_secret(uint8_t *secret, uint64_t seed)
+{
+	int i;
+
+	for (i = 0; i < XXH3_SECRET_SIZE; i += 16) {
+		xxh_le64enc(secret + i, xxh_le64dec(xxh3_ksecret + i) + seed);
+		xxh_le64enc(secret + i + 8, xxh_le64dec(xxh3_ksecret + i + 8) - seed);
+	}
+}
+
+/*
+ * XXH3 - stripe loop.
+ *
+ * Each 64-byte stripe updates 8 accumulators, secret moves
+ * 8 bytes per stripe, accumulators are scrambled after each block.
+ */
+
+typedef void (*xxh3_accumulate_fn)(uint64_t *acc, const uint8_t *p, const uint8_t *secret, size_t nstripes);
+typedef void (*xxh3_scramble_fn)(uint64_t *acc, const uint8_t *secret);
+
+#ifndef XXH_USE_SSE2
+
+static void xxh3_accumulate_scalar(uint64_t *acc, const uint8_t *p, const uint8_t *secret, size_t nstripes)
+{
+	uint64_t val, key;
+	size_t n;
+	int i;
+
+	for (n = 0; n < nstripes; n++, p += XXH3_STRIPE_LEN, secret += XXH3_CONSUME_RATE) {
+		for (i = 0; i < XXH3_ACC_NB; i++) {
+			val = xxh_le64dec(p + i * 8);
+			key = val ^ xxh_le64dec(secret + i * 8);
+			acc[i ^ 1] += val;
+			acc[i] += (key & 0xFFFFFFFF) * (key >> 32);
+		}
+	}
+}
+
+static void xxh3_scramble_scalar(uint64_t *acc, const uint8_t *secret)
+{
+	uint64_t a;
+	int i;
+
+	for (i = 0; i < XXH3_ACC_NB; i++) {
+		a = acc[i];
+		a ^= a >> 47;
+		a ^= xxh_le64dec(secret + i * 8);
+		acc[i] = a * PRIME32_1;
+	}
+}
+
+#else
+
+static void xxh3_accumulate_sse2(uint64_t *acc, const uint8_t *p, const uint8_t *secret, size_t nstripes)
+{
+	__m128i a[4], data, key, dk, shuf;
+	size_t n;
+	int i;
+
+	for (i = 0; i < 4; i++)
+		a[i] = _mm_loadu_si128((const __m128i *)acc + i);
+
+	for (n = 0; n < nstripes; n++, p += XXH3_STRIPE_LEN, secret += XXH3_CONSUME_RATE) {
+		for (i = 0; i < 4; i++) {
+			data = _mm_loadu_si128((const __m128i *)p + i);
+			key = _mm_loadu_si128((const __m128i *)secret + i);
+			dk = _mm_xor_si128(data, key);
+			shuf = _mm_shuffle_epi32(dk, _MM_SHUFFLE(0, 3, 0, 1));
+			a[i] = _mm_add_epi64(a[i], _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2)));
+			a[i] = _mm_add_epi64(a[i], _mm_mul_epu32(dk, shuf));
+		}
+	}
+
+	for (i = 0; i < 4; i++)
+		_mm_storeu_si128((__m128i *)acc + i, a[i]);
+}
+
+static void xxh3_scramble_sse2(uint64_t *acc, const uint8_t *secret)
+{
+	const __m128i prime = _mm_set1_epi32((int)PRIME32_1);
+	__m128i a, hi;
+	int i;
+
+	for (i = 0; i < 4; i++) {
+		a = _mm_loadu_si128((const __m128i *)acc + i);
+		a = _mm_xor_si128(a, _mm_srli_epi64(a, 47));
+		a = _mm_xor_si128(a, _mm_loadu_si128((const __m128i *)secret + i));
+		hi = _mm_shuffle_epi32(a, _MM_SHUFFLE(0, 3, 0, 1));
+		a = _mm_add_epi64(_mm_mul_epu32(a, prime), _mm_slli_epi64(_mm_mul_epu32(hi, prime), 32));
+		_mm_storeu_si128((__m128i *)acc + i, a);
+	}
+}
+
+#endif
+
+#ifdef XXH_USE_AVX2
+
+XXH_TARGET_AVX2
+static void xxh3_accumulate_avx2(uint64_t *acc, const uint8_t *p, const uint8_t *secret, size_t nstripes)
+{
+	__m256i a[2], data, key, dk, shuf;
+	size_t n;
+	int i;
+
+	for (i = 0; i < 2; i++)
+		a[i] = _mm256_loadu_si256((const __m256i *)acc + i);
+
+	for (n = 0; n < nstripes; n++, p += XXH3_STRIPE_LEN, secret += XXH3_CONSUME_RATE) {
+		for (i = 0; i < 2; i++) {
+			data = _mm256_loadu_si256((const __m256i *)p + i);
+			key = _mm256_loadu_si256((const __m256i *)secret + i);
+			dk = _mm256_xor_si256(data, key);
+			shuf = _mm256_srli_epi64(dk, 32);
+			a[i] = _mm256_add_epi64(a[i], _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2)));
+			a[i] = _mm256_add_epi64(a[i], _mm256_mul_epu32(dk, shuf));
+		}
+	}
+
+	for (i = 0; i < 2; i++)
+		_mm256_storeu_si256((__m256i *)acc + i, a[i]);
+}
+
+XXH_TARGET_AVX2
+static void xxh3_scramble_avx2(uint64_t *acc, const uint8_t *secret)
+{
+	const __m256i prime = _mm256_set1_epi32((int)PRIME32_1);
+	__m256i a, hi;
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		a = _mm256_loadu_si256((const __m256i *)acc + i);
+		a = _mm256_xor_si256(a, _mm256_srli_epi64(a, 47));
+		a = _mm256_xor_si256(a, _mm256_loadu_si256((const __m256i *)secret + i));
+		hi = _mm256_srli_epi64(a, 32);
+		a = _mm256_add_epi64(_mm256_mul_epu32(a, prime), _mm256_slli_epi64(_mm256_mul_epu32(hi, prime), 32));
+		_mm256_storeu_si256((__m256i *)acc + i, a);
+	}
+}
+
+#endif
+
+struct xxh3_impl {
+	xxh3_accumulate_fn accumulate;
+	xxh3_scramble_fn scramble;
+};
+
+static const struct xxh3_impl xxh3_impl_default = {
+#ifdef XXH_USE_SSE2
+	xxh3_accumulate_sse2, xxh3_scramble_sse2
+#else
+	xxh3_accumulate_scalar, xxh3_scramble_scalar
+#endif
+};
+
+#ifdef XXH_USE_AVX2
+static const struct xxh3_impl xxh3_impl_avx2 = {
+	xxh3_accumulate_avx2, xxh3_scramble_avx2
+};
+#endif
+
+/* pick stripe loop for this CPU, once */
+static const struct xxh3_impl *xxh3_get_impl(void)
+{
+	static const struct xxh3_impl *impl;
+
+	if (impl == NULL) {
+		impl = &xxh3_impl_default;
+#ifdef XXH_USE_AVX2
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2"))
+			impl = &xxh3_impl_avx2;
+#endif
+	}
+	return impl;
+}
+
+static const uint8_t *xxh3_consume_stripes(const struct xxh3_impl *impl, uint64_t *acc,
+					   size_t *stripes_done, const uint8_t *p, size_t nstripes,
+					   const uint8_t *secret)
+{
+	size_t n;
+
+	while (nstripes > 0) {
+		n = XXH3_BLOCK_STRIPES - *stripes_done;
+		if (n > nstripes)
+			n = nstripes;
+		impl->accumulate(acc, p, secret + *stripes_done * XXH3_CONSUME_RATE, n);
+		p += n * XXH3_STRIPE_LEN;
+		nstripes -= n;
+		*stripes_done += n;
+		if (*stripes_done == XXH3_BLOCK_STRIPES) {
+			impl->scramble(acc, secret + XXH3_SECRET_LIMIT);
+			*stripes_done = 0;
+		}
+	}
+	return p;
+}
+
+static inline void xxh3_init_acc(uint64_t *acc)
+{
+	acc[0] = PRIME32_3;
+	acc[1] = PRIME64_1;
+	acc[2] = PRIME64_2;
+	acc[3] = PRIME64_3;
+	acc[4] = PRIME64_4;
+	acc[5] = PRIME32_2;
+	acc[6] = PRIME64_5;
+	acc[7] = PRIME32_1;
+}
+
+static uint64_t xxh3_merge_accs(const uint64_t *acc, const uint8_t *secret, uint64_t start)
+{
+	uint64_t h = start;
+	int i;
+
+	for (i = 0; i < 4; i++)
+		h += mul128_fold64(acc[2 * i] ^ xxh_le64dec(secret + 16 * i),
+				   acc[2 * i + 1] ^ xxh_le64dec(secret + 16 * i + 8));
+	return xxh3_avalanche(h);
+}
+
+/* accumulators for input longer than XXH3_MIDSIZE_MAX */
+static void xxh3_hash_long(uint64_t *acc, const uint8_t *p, size_t len, const uint8_t *secret)
+{
+	const struct xxh3_impl *impl = xxh3_get_impl();
+	size_t stripes_done = 0;
+
+	xxh3_init_acc(acc);
+
+	/* last stripe is always processed separately, even if full */
+	xxh3_consume_stripes(impl, acc, &stripes_done, p, (len - 1) / XXH3_STRIPE_LEN, secret);
+	impl->accumulate(acc, p + len - XXH3_STRIPE_LEN,
+			 secret + XXH3_SECRET_LIMIT - XXH3_LASTACC_START, 1);
+}
+
+/*
+ * XXH3 64-bit
+ */
+
+static uint64_t xxh3_64_short(const uint8_t *p, size_t len, const uint8_t *secret, uint64_t seed)
+{
+	uint64_t acc, lo, hi, flip;
+	uint32_t combined;
+
+	if (len > 8) {
+		lo = xxh_le64dec(p) ^ ((xxh_le64dec(secret + 24) ^ xxh_le64dec(secret + 32)) + seed);
+		hi = xxh_le64dec(p + len - 8) ^ ((xxh_le64dec(secret + 40) ^ xxh_le64dec(secret + 48)) - seed);
+		acc = len + swap64(lo) + hi + mul128_fold64(lo, hi);
+		return xxh3_avalanche(acc);
+	} else if (len >= 4) {
+		seed ^= (uint64_t)swap32((uint32_t)seed) << 32;
+		flip = (xxh_le64dec(secret + 8) ^ xxh_le64dec(secret + 16)) - seed;
+		acc = ((uint64_t)xxh_le32dec(p) << 32) + xxh_le32dec(p + len - 4);
+		return xxh3_rrmxmx(acc ^ flip, len);
+	} else if (len > 0) {
+		combined = ((uint32_t)p[0] << 16) | ((uint32_t)p[len >> 1] << 24)
+			| (uint32_t)p[len - 1] | ((uint32_t)len << 8);
+		flip = (xxh_le32dec(secret) ^ xxh_le32dec(secret + 4)) + seed;
+		return xxh64_avalanche(combined ^ flip);
+	}
+	return xxh64_avalanche(seed ^ xxh_le64dec(secret + 56) ^ xxh_le64dec(secret + 64));
+}
+
+static uint64_t xxh3_64_mid(const uint8_t *p, size_t len, const uint8_t *secret, uint64_t seed)
+{
+	uint64_t acc = len * PRIME64_1;
+	uint64_t acc_end;
+	unsigned i, nrounds;
+
+	if (len <= 128) {
+		if (len > 32) {
+			if (len > 64) {
+				if (len > 96) {
+					acc += xxh3_mix16(p + 48, secret + 96, seed);
+					acc += xxh3_mix16(p + len - 64, secret + 112, seed);
+				}
+				acc += xxh3_mix16(p + 32, secret + 64, seed);
+				acc += xxh3_mix16(p + len - 48, secret + 80, seed);
+			}
+			acc += xxh3_mix16(p + 16, secret + 32, seed);
+			acc += xxh3_mix16(p + len - 32, secret + 48, seed);
+		}
+		acc += xxh3_mix16(p, secret, seed);
+		acc += xxh3_mix16(p + len - 16, secret + 16, seed);
+		return xxh3_avalanche(acc);
+	}
+
+	nrounds = len / 16;
+	for (i = 0; i < 8; i++)
+		acc += xxh3_mix16(p + 16 * i, secret + 16 * i, seed);
+	acc_end = xxh3_mix16(p + len - 16, secret + XXH3_SECRET_MIN - XXH3_MIDSIZE_LAST, seed);
+	acc = xxh3_avalanche(acc);
+	for (i = 8; i < nrounds; i++)
+		acc_end += xxh3_mix16(p + 16 * i, secret + 16 * (i - 8) + XXH3_MIDSIZE_START, seed);
+	return xxh3_avalanche(acc + acc_end);
+}
+
+static uint64_t xxh3_64(const void *data, size_t len, uint64_t seed)
+{
+	const uint8_t *p = data;
+	uint8_t secret[XXH3_SECRET_SIZE];
+	uint64_t acc[XXH3_ACC_NB];
+
+	if (len <= 16)
+		return xxh3_64_short(p, len, xxh3_ksecret, seed);
+	if (len <= XXH3_MIDSIZE_MAX)
+		return xxh3_64_mid(p, len, xxh3_ksecret, seed);
+
+	if (seed == 0) {
+		xxh3_hash_long(acc, p, len, xxh3_ksecret);
+		return xxh3_merge_accs(acc, xxh3_ksecret + XXH3_MERGEACCS_START, len * PRIME64_1);
+	}
+	xxh3_init_secret(secret, seed);
+	xxh3_hash_long(acc, p, len, secret);
+	return xxh3_merge_accs(acc, secret + XXH3_MERGEACCS_START, len * PRIME64_1);
+}
+
+void hlib_xxh3_64(const void *data, size_t len, uint64_t *io)
+{
+	io[0] = xxh3_64(data, len, io[0]);
+}
+
+/*
+ * XXH3 128-bit
+ */
+
+static void xxh3_128_short(const uint8_t *p, size_t len, const uint8_t *secret, uint64_t seed, uint64_t *out)
+{
+	uint64_t lo, hi, flip_lo, flip_hi, in_lo, in_hi, keyed, h_lo, h_hi;
+	uint32_t comb_lo, comb_hi;
+
+	if (len > 8) {
+		flip_lo = (xxh_le64dec(secret + 32) ^ xxh_le64dec(secret + 40)) - seed;
+		flip_hi = (xxh_le64dec(secret + 48) ^ xxh_le64dec(secret + 56)) + seed;
+		in_lo = xxh_le64dec(p);
+		in_hi = xxh_le64dec(p + len - 8);
+		mult64to128(in_lo ^ in_hi ^ flip_lo, PRIME64_1, &lo, &hi);
+		lo += (uint64_t)(len - 1) << 54;
+		in_hi ^= flip_hi;
+		hi += in_hi + (uint64_t)(uint32_t)in_hi * (PRIME32_2 - 1);
+		lo ^= swap64(hi);
+		mult64to128(lo, PRIME64_2, &h_lo, &h_hi);
+		h_hi += hi * PRIME64_2;
+		out[0] = xxh3_avalanche(h_lo);
+		out[1] = xxh3_avalanche(h_hi);
+	} else if (len >= 4) {
+		seed ^= (uint64_t)swap32((uint32_t)seed) << 32;
+		in_lo = xxh_le32dec(p) + ((uint64_t)xxh_le32dec(p + len - 4) << 32);
+		keyed = in_lo ^ ((xxh_le64dec(secret + 16) ^ xxh_le64dec(secret + 24)) + seed);
+		mult64to128(keyed, PRIME64_1 + (len << 2), &lo, &hi);
+		hi += lo << 1;
+		lo ^= hi >> 3;
+		lo ^= lo >> 35;
+		lo *= PRIME_MX2;
+		lo ^= lo >> 28;
+		out[0] = lo;
+		out[1] = xxh3_avalanche(hi);
+	} else if (len > 0) {
+		comb_lo = ((uint32_t)p[0] << 16) | ((uint32_t)p[len >> 1] << 24)
+			| (uint32_t)p[len - 1] | ((uint32_t)len << 8);
+		comb_hi = rotl32(swap32(comb_lo), 13);
+		flip_lo = (xxh_le32dec(secret) ^ xxh_le32dec(secret + 4)) + seed;
+		flip_hi = (xxh_le32dec(secret + 8) ^ xxh_le32dec(secret + 12)) - seed;
+		out[0] = xxh64_avalanche(comb_lo ^ flip_lo);
+		out[1] = xxh64_avalanche(comb_hi ^ flip_hi);
+	} else {
+		out[0] = xxh64_avalanche(seed ^ xxh_le64dec(secret + 64) ^ xxh_le64dec(secret + 72));
+		out[1] = xxh64_avalanche(seed ^ xxh_le64dec(secret + 80) ^ xxh_le64dec(secret + 88));
+	}
+}
+
+static inline void xxh3_mix32(uint64_t *acc, const uint8_t *p1, const uint8_t *p2,
+			      const uint8_t *secret, uint64_t seed)
+{
+	acc[0] += xxh3_mix16(p1, secret, seed);
+	acc[0] ^= xxh_le64dec(p2) + xxh_le64dec(p2 + 8);
+	acc[1] += xxh3_mix16(p2, secret + 16, seed);
+	acc[1] ^= xxh_le64dec(p1) + xxh_le64dec(p1 + 8);
+}
+
+static void xxh3_128_mid(const uint8_t *p, size_t len, const uint8_t *secret, uint64_t seed, uint64_t *out)
+{
+	uint64_t acc[2];
+	unsigned i;
+
+	acc[0] = len * PRIME64_1;
+	acc[1] = 0;
+
+	if (len <= 128) {
+		if (len > 32) {
+			if (len > 64) {
+				if (len > 96)
+					xxh3_mix32(acc, p + 48, p + len - 64, secret + 96, seed);
+				xxh3_mix32(acc, p + 32, p + len - 48, secret + 64, seed);
+			}
+			xxh3_mix32(acc, p + 16, p + len - 32, secret + 32, seed);
+		}
+		xxh3_mix32(acc, p, p + len - 16, secret, seed);
+	} else {
+		for (i = 32; i < 160; i += 32)
+			xxh3_mix32(acc, p + i - 32, p + i - 16, secret + i - 32, seed);
+		acc[0] = xxh3_avalanche(acc[0]);
+		acc[1] = xxh3_avalanche(acc[1]);
+		for (i = 160; i <= len; i += 32)
+			xxh3_mix32(acc, p + i - 32, p + i - 16, secret + XXH3_MIDSIZE_START + i - 160, seed);
+		xxh3_mix32(acc, p + len - 16, p + len - 32,
+			   secret + XXH3_SECRET_MIN - XXH3_MIDSIZE_LAST - 16, 0 - seed);
+	}
+
+	out[0] = xxh3_avalanche(acc[0] + acc[1]);
+	out[1] = 0 - xxh3_avalanche(acc[0] * PRIME64_1 + acc[1] * PRIME64_4 + (len - seed) * PRIME64_2);
+}
+
+static void xxh3_128_merge(const uint64_t *acc, const uint8_t *secret, size_t len, uint64_t *out)
+{
+	out[0] = xxh3_merge_accs(acc, secret + XXH3_MERGEACCS_START, len * PRIME64_1);
+	out[1] = xxh3_merge_accs(acc, secret + XXH3_SECRET_SIZE - 64 - XXH3_MERGEACCS_START,
+				 ~(len * PRIME64_2));
+}
+
+static void xxh3_128(const void *data, size_t len, uint64_t seed, uint64_t *out)
+{
+	const uint8_t *p = data;
+	uint8_t secret[XXH3_SECRET_SIZE];
+	uint64_t acc[XXH3_ACC_NB];
+
+	if (len <= 16) {
+		xxh3_128_short(p, len, xxh3_ksecret, seed, out);
+	} else if (len <= XXH3_MIDSIZE_MAX) {
+		xxh3_128_mid(p, len, xxh3_ksecret, seed, out);
+	} else if (seed == 0) {
+		xxh3_hash_long(acc, p, len, xxh3_ksecret);
+		xxh3_128_merge(acc, xxh3_ksecret, len, out);
+	} else {
+		xxh3_init_secret(secret, seed);
+		xxh3_hash_long(acc, p, len, secret);
+		xxh3_128_merge(acc, secret, len, out);
+	}
+}
+
+/* io[0] is seed, result is low half in io[0] and high half in io[1] */
+void hlib_xxh3_128(const void *data, size_t len, uint64_t *io)
+{
+	xxh3_128(data, len, io[0], io);
+}
+
+
+/*
+ * Incremental API.
+ */
+
+struct xxh64_stream {
+	uint64_t v[4];
+	uint64_t seed;
+	uint64_t len;
+	uint8_t buf[32];
+};
+
+static void xxh64_stream_init(void *state, const uint64_t *io)
+{
+	struct xxh64_stream *st = state;
+	st->seed = io[0];
+	xxh64_init_lanes(st->v, st->seed);
+	st->len = 0;
+}
+
+static void xxh64_stream_update(void *state, const void *data, size_t len)
+{
+	struct xxh64_stream *st = state;
+	const uint8_t *p = data;
+	unsigned pos = st->len % 32;
+	unsigned n;
+
+	st->len += len;
+
+	/* fill partial block */
+	if (pos > 0) {
+		n = 32 - pos;
+		if (n > len) {
+			memcpy(st->buf + pos, p, len);
+			return;
+		}
+		memcpy(st->buf + pos, p, n);
+		p += n;
+		len -= n;
+		xxh64_blocks(st->v, st->buf, 32);
+	}
+
+	/* full blocks, keep tail */
+	p = xxh64_blocks(st->v, p, len);
+	memcpy(st->buf, p, len % 32);
+}
+
+static void xxh64_stream_final(void *state, uint64_t *io)
+{
+	struct xxh64_stream *st = state;
+	uint64_t h;
+
+	if (st->len >= 32)
+		h = xxh64_converge(st->v);
+	else
+		h = st->seed + PRIME64_5;
+	h += st->len;
+	io[0] = xxh64_finalize(h, st->buf, st->len);
+}
+
+const struct HashStreamOps hlib_xxh64_stream = {
+	sizeof(struct xxh64_stream),
+	xxh64_stream_init,
+	xxh64_stream_update,
+	xxh64_stream_final,
+};
+
+/*
+ * XXH3 stream buffers 256 bytes, so short inputs can be hashed
+ * with one-shot code at the end.  Last stripe of consumed data is
+ * kept at end of buffer, as final stripe may overlap it.
+ */
+
+#define XXH3_BUFFER_SIZE	256
+#define XXH3_BUFFER_STRIPES	(XXH3_BUFFER_SIZE / XXH3_STRIPE_LEN)
+
+struct xxh3_stream {
+	uint64_t acc[XXH3_ACC_NB];
+	uint8_t secret[XXH3_SECRET_SIZE];
+	uint8_t buf[XXH3_BUFFER_SIZE];
+	uint64_t seed;
+	uint64_t len;
+	size_t buffered;
+	size_t stripes_done;
+};
+
+static void xxh3_stream_init(void *state, const uint64_t *io)
+{
+	struct xxh3_stream *st = state;
+	st->seed = io[0];
+	xxh3_init_secret(st->secret, st->seed);
+	xxh3_init_acc(st->acc);
+	st->len = 0;
+	st->buffered = 0;
+	st->stripes_done = 0;
+}
+
+static void xxh3_stream_update(void *state, const void *data, size_t len)
+{
+	struct xxh3_stream *st = state;
+	const struct xxh3_impl *impl = xxh3_get_impl();
+	const uint8_t *p = data;
+	const uint8_t *end = p + len;
+	size_t n;
+
+	st->len += len;
+
+	if (len <= XXH3_BUFFER_SIZE - st->buffered) {
+		memcpy(st->buf + st->buffered, p, len);
+		st->buffered += len;
+		return;
+	}
+
+	/* there is more data coming, so full buffer can be consumed */
+	if (st->buffered > 0) {
+		n = XXH3_BUFFER_SIZE - st->buffered;
+		memcpy(st->buf + st->buffered, p, n);
+		p += n;
+		xxh3_consume_stripes(impl, st->acc, &st->stripes_done, st->buf, XXH3_BUFFER_STRIPES, st->secret);
+		st->buffered = 0;
+	}
+
+	/* consume stripes directly from input, always leave some for final */
+	if (end - p > XXH3_BUFFER_SIZE) {
+		n = (end - p - 1) / XXH3_STRIPE_LEN;
+		p = xxh3_consume_stripes(impl, st->acc, &st->stripes_done, p, n, st->secret);
+		memcpy(st->buf + XXH3_BUFFER_SIZE - XXH3_STRIPE_LEN, p - XXH3_STRIPE_LEN, XXH3_STRIPE_LEN);
+	}
+
+	memcpy(st->buf, p, end - p);
+	st->buffered = end - p;
+}
+
+/* finish long input on copy of accumulators */
+static void xxh3_stream_long(const struct xxh3_stream *st, uint64_t *acc)
+{
+	const struct xxh3_impl *impl = xxh3_get_impl();
+	uint8_t last[XXH3_STRIPE_LEN];
+	const uint8_t *lastp;
+	size_t stripes_done = st->stripes_done;
+	size_t n;
+
+	memcpy(acc, st->acc, sizeof(st->acc));
+	if (st->buffered >= XXH3_STRIPE_LEN) {
+		xxh3_consume_stripes(impl, acc, &stripes_done, st->buf, (st->buffered - 1) / XXH3_STRIPE_LEN, st->secret);
+		lastp = st->buf + st->buffered - XXH3_STRIPE_LEN;
+	} else {
+		n = XXH3_STRIPE_LEN - st->buffered;
+		memcpy(last, st->buf + XXH3_BUFFER_SIZE - n, n);
+		memcpy(last + n, st->buf, st->buffered);
+		lastp = last;
+	}
+	impl->accumulate(acc, lastp, st->secret + XXH3_SECRET_LIMIT - XXH3_LASTACC_START, 1);
+}
+
+static void xxh3_64_stream_final(void *state, uint64_t *io)
+{
+	struct xxh3_stream *st = state;
+	uint64_t acc[XXH3_ACC_NB];
+
+	if (st->len <= XXH3_MIDSIZE_MAX) {
+		io[0] = xxh3_64(st->buf, st->len, st->seed);
+		return;
+	}
+	xxh3_stream_long(st, acc);
+	io[0] = xxh3_merge_accs(acc, st->secret + XXH3_MERGEACCS_START, st->len * PRIME64_1);
+}
+
+static void xxh3_128_stream_final(void *state, uint64_t *io)
+{
+	struct xxh3_stream *st = state;
+	uint64_t acc[XXH3_ACC_NB];
+
+	if (st->len <= XXH3_MIDSIZE_MAX) {
+		xxh3_128(st->buf, st->len, st->seed, io);
+		return;
+	}
+	xxh3_stream_long(st, acc);
+	xxh3_128_merge(acc, st->secret, st->len, io);
+}
+
+const struct HashStreamOps hlib_xxh3_64_stream = {
+	sizeof(struct xxh3_stream),
+	xxh3_stream_init,
+	xxh3_stream_update,
+	xxh3_64_stream_final,
+};
+
+const struct HashStreamOps hlib_xxh3_128_stream = {
+	sizeof(struct xxh3_stream),
+	xxh3_stream_init,
+	xxh3_stream_update,
+	xxh3_128_stream_final,
+};
@@ -0,0 +1,66 @@
+
+--
+-- hashlib_fingerprint
+--
+
+-- single row gives plain 128-bit hash
+select (select hashlib_fingerprint(x, 'md5') from (values ('abc'::text)) v(x))
+  = hash128_string('abc', 'md5');
+
+-- order does not matter
+select (select hashlib_fingerprint(s, 'city128') from (select x::text as s from generate_series(1, 1000) x order by x) t)
+  = (select hashlib_fingerprint(s, 'city128') from (select x::text as s from generate_series(1, 1000) x order by x desc) t);
+
+-- content does
+select (select hashlib_fingerprint(s, 'city128') from (select x::text as s from generate_series(1, 1000) x) t)
+  = (select hashlib_fingerprint(s, 'city128') from (select x::text as s from generate_series(2, 1001) x) t);
+
+-- nulls are skipped
+select (select hashlib_fingerprint(s, 'spooky') from (values ('a'::bytea), (null), ('b')) v(s))
+  = (select hashlib_fingerprint(s, 'spooky') from (values ('b'::bytea), ('a')) v(s));
+
+-- empty input
+select encode(hashlib_fingerprint(x, 'spooky'), 'hex') from (select ''::text as x where false) t;
+select encode(hashlib_fingerprint(x, 'spooky'), 'hex') from (values (null::text), (null::text)) v(x);
+select hashlib_fingerprint(x, 'crc32') from (values ('a'::text)) v(x);
+
+--
+-- streaming hash aggregates
+--
+
+-- same as hashing concatenated values
+select hash128_string_agg(s, 'md5' order by x) = hash128_string(string_agg(s, '' order by x), 'md5')
+  from (select x, repeat(x::text, x % 50) as s from generate_series(1, 300) x) t;
+select hash128_string_agg(s, 'md5', 5 order by x) = hash128_string(string_agg(s, '' order by x), 'md5', 5)
+  from (select x, repeat(x::text, x % 50) as s from generate_series(1, 300) x) t;
+select hash128_string_agg(s, 'spooky' order by x) = hash128_string(string_agg(s, '' order by x), 'spooky')
+  from (select x, repeat(x::text, x % 50) as s from generate_series(1, 300) x) t;
+select hash128_string_agg(s, 'spooky' order by x) = hash128_string(string_agg(s, '' order by x), 'spooky')
+  from (select x, repeat('x', x) as s from generate_series(1, 10) x) t;
+select hash64_string_agg(s, 'siphash24' order by x) = hash64_string(string_agg(s, '' order by x), 'siphash24')
+  from (select x, repeat(x::text, x % 7) as s from generate_series(1, 300) x) t;
+select hash64_string_agg(s, 'siphash13' order by x) = hash64_string(string_agg(s, '' order by x), 'siphash13')
+  from (select x, repeat(x::text, x % 7) as s from generate_series(1, 300) x) t;
+select hash_string_agg(s, 'murmur3', 42 order by x) = hash_string(string_agg(s, '' order by x), 'murmur3', 42)
+  from (select x, repeat(x::text, x % 7) as s from generate_series(1, 300) x) t;
+select hash_string_agg(s, 'crc32' order by x) = hash_string(string_agg(s, '' order by x), 'crc32')
+  from (select x, x::text as s from generate_series(1, 300) x) t;
+select hash_string_agg(s, 'crc32c' order by x) = hash_string(string_agg(s, '' order by x), 'crc32c')
+  from (select x, repeat(x::text, x % 50) as s from generate_series(1, 300) x) t;
+select hash64_string_agg(s, 'xxh64', 42 order by x) = hash64_string(string_agg(s, '' order by x), 'xxh64', 42)
+  from (select x, repeat(x::text, x % 7) as s from generate_series(1, 300) x) t;
+select hash64_string_agg(s, 'xxh3_64' order by x) = hash64_string(string_agg(s, '' order by x), 'xxh3_64')
+  from (select x, repeat(x::text, x % 50) as s from generate_series(1, 300) x) t;
+select hash128_string_agg(s, 'xxh3_128', 42 order by x) = hash128_string(string_agg(s, '' order by x), 'xxh3_128', 42)
+  from (select x, repeat(x::text, x % 50) as s from generate_series(1, 300) x) t;
+select hash128_string_agg(s, 'xxh3_128' order by x) = hash128_string(string_agg(s, '' order by x), 'xxh3_128')
+  from (select x, repeat('x', x) as s from generate_series(1, 20) x) t;
+
+-- nulls are skipped, empty input gives null
+select hash_string_agg(s, 'crc32') = hash_string('ab'::bytea, 'crc32')
+  from (values ('a'::bytea), (null), ('b')) v(s);
+select hash64_string_agg(s, 'crc32') is null from (select ''::text as s where false) t;
+select hash_string_agg(s, 'crc32') is null from (values (null::text), (null::text)) v(s);
+
+-- algorithm must support incremental hashing
+select hash64_string_agg(x::text, 'city64') from generate_series(1, 3) x;
@@ -0,0 +1,60 @@
+
+-- by-value and 8-byte types hash little-endian value bytes
+select hash64_any(1::int4, 'siphash24') = hash64_string('\x01000000'::bytea, 'siphash24');
+select hash64_any(-2::int2, 'siphash24') = hash64_string('\xfeff'::bytea, 'siphash24');
+select hash64_any(1::int8, 'siphash24') = hash64_string('\x0100000000000000'::bytea, 'siphash24');
+select hash64_any(1.5::float8, 'siphash24') = hash64_string('\x000000000000f83f'::bytea, 'siphash24');
+select hash64_any(true, 'siphash24') = hash64_string('\x01'::bytea, 'siphash24');
+select hash64_any('2000-01-01 00:00:01+00'::timestamptz, 'siphash24')
+       = hash64_string('\x40420f0000000000'::bytea, 'siphash24');
+
+-- float -0 and NaNs hash same as equal values
+select hash64_any('-0'::float8, 'siphash24') = hash64_any('0'::float8, 'siphash24');
+select hash64_any('-0'::float4, 'siphash24') = hash64_any('0'::float4, 'siphash24');
+select hash64_any('NaN'::float8, 'siphash24') = hash64_string('\x000000000000f87f'::bytea, 'siphash24');
+select hash64_any(-'NaN'::float8, 'siphash24') = hash64_any('NaN'::float8, 'siphash24');
+select hash64_any(-'NaN'::float4, 'siphash24') = hash64_any('NaN'::float4, 'siphash24');
+
+-- strings same as hash_string
+select hash64_any('abc'::text, 'siphash24') = hash64_string('abc', 'siphash24');
+select hash64_any('abc'::varchar, 'siphash24') = hash64_string('abc', 'siphash24');
+select hash64_any('\x0102'::bytea, 'siphash24') = hash64_string('\x0102'::bytea, 'siphash24');
+select hash64_any('abc'::name, 'siphash24') = hash64_string('abc', 'siphash24');
+-- bpchar without trailing spaces, same as bpchar equality
+select hash64_any('abc  '::char(5), 'siphash24') = hash64_string('abc', 'siphash24');
+select hash64_any(array['ab'::char(3)], 'siphash24') = hash64_any(array['ab'::char(5)], 'siphash24');
+
+-- other types via send function
+select hash64_any('a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11'::uuid, 'siphash24')
+       = hash64_string(uuid_send('a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11'), 'siphash24');
+select hash64_any(1.5::numeric, 'siphash24') = hash64_string(numeric_send(1.5), 'siphash24');
+
+-- arrays: ndim, dims, lbounds, then null flag and element
+select hash64_any(array[1, 2]::int4[], 'siphash24')
+       = hash64_string('\x01000000020000000100000000010000000002000000'::bytea, 'siphash24');
+select hash64_any(array['a', null]::text[], 'siphash24')
+       = hash64_string('\x01000000020000000100000000010000006101'::bytea, 'siphash24');
+select hash64_any(array['ab', 'c'], 'siphash24') <> hash64_any(array['a', 'bc'], 'siphash24');
+
+-- records: number of columns, then null flag and column
+select hash64_any(row(1, 'ab'::text), 'siphash24')
+       = hash64_string('\x02000000000100000000020000006162'::bytea, 'siphash24');
+select hash64_any(row(1, null::text), 'siphash24') <> hash64_any(row(1, ''::text), 'siphash24');
+
+-- other widths
+select hash_any(1::int4, 'crc32') = hash_string('\x01000000'::bytea, 'crc32');
+select hash128_any(1::int4, 'md5') = hash128_string('\x01000000'::bytea, 'md5');
+select hash128_any(array[1, 2]::int8[], 'spooky')
+       = hash128_string('\x010000000200000001000000000100000000000000000200000000000000'::bytea, 'spooky');
+
+-- text inside send output does not depend on client encoding
+create temp table any_enc as
+  select j, hash64_any(j, 'city64') as hj, hash64_any(j::jsonb, 'city64') as hjb
+    from (select json_build_object('a', chr(233)) as j) t;
+set client_encoding = 'LATIN1';
+select hash64_any(j, 'city64') = hj, hash64_any(j::jsonb, 'city64') = hjb from any_enc;
+reset client_encoding;
+
+-- unknown hash
+select hash64_any(1, 'nonexistent');
+
@@ -0,0 +1,21 @@
+
+-- array variants must match scalar functions
+
+select hash_string(array['', 'a', 'abcdefg'], 'crc32')
+  = array[hash_string('', 'crc32'), hash_string('a', 'crc32'), hash_string('abcdefg', 'crc32')];
+select hash_string(array['a', 'abcdefg'], 'lookup2', 5)
+  = array[hash_string('a', 'lookup2', 5), hash_string('abcdefg', 'lookup2', 5)];
+select hash64_string(array['a', 'abc', null, '0123456789abcdef0'], 'city64')
+  = array[hash64_string('a', 'city64'), hash64_string('abc', 'city64'), null, hash64_string('0123456789abcdef0', 'city64')];
+select hash64_string('{a,abc}'::bytea[], 'siphash24', 1, 2)
+  = array[hash64_string('a'::bytea, 'siphash24', 1, 2), hash64_string('abc'::bytea, 'siphash24', 1, 2)];
+select hash128_string(array['abc', 'message digest'], 'md5')
+  = array[hash128_string('abc', 'md5'), hash128_string('message digest', 'md5')];
+
+-- dimensions and bounds are kept
+select hash_string('{{a,b},{c,d}}'::text[], 'murmur3')
+  = array[[hash_string('a', 'murmur3'), hash_string('b', 'murmur3')],
+          [hash_string('c', 'murmur3'), hash_string('d', 'murmur3')]];
+select array_lower(hash_string('[3:4]={a,b}'::text[], 'murmur3'), 1);
+select hash128_string('{}'::bytea[], 'md5');
+select hash64_string(array[null, null]::text[], 'spooky');
@@ -0,0 +1,38 @@
+
+-- stable format
+select bloom_agg(x, 3, 0.1) from (values ('a'), ('b'), ('c')) v(x);
+select hashlib_bloom_send(bloom_agg(x, 3, 0.1)) = decode('0104000010000000636974793132380000000000000000005dd2', 'hex')
+  from (values ('a'), ('b'), ('c')) v(x);
+select '\x0104000010000000636974793132380000000000000000005dd2'::hashlib_bloom @> 'a'::text,
+       '\x0104000010000000636974793132380000000000000000005dd2'::hashlib_bloom @> 'b'::bytea;
+
+-- all members found, few false positives
+create temp table bloom_test as
+  select bloom_agg(x::text, 1000, 0.01) as b1,
+         bloom_agg(x::text, 1000, 0.01, 'spooky') as b2,
+         bloom_agg(x::text::bytea, 1000, 0.01, 'md5') as b3
+    from generate_series(1, 1000) x;
+select bool_and(b1 @> x::text), bool_and(b2 @> x::text), bool_and(bloom_contains(b3, x::text::bytea))
+  from bloom_test, generate_series(1, 1000) x;
+select count(*) filter (where b1 @> x::text) < 30, count(*) filter (where b2 @> x::text) < 30
+  from bloom_test, generate_series(1001, 3000) x;
+
+-- union is same as building from all values
+select bloom_agg(x::text, 1000, 0.01)::text = (select b1::text from bloom_test) from generate_series(1, 1000) x;
+select ((select bloom_agg(x::text, 1000, 0.01) from generate_series(1, 500) x)
+       | (select bloom_agg(x::text, 1000, 0.01) from generate_series(501, 1000) x))::text
+       = (select b1::text from bloom_test);
+select (select bloom_agg(x::text, 100, 0.01) from generate_series(1, 10) x)
+       | (select bloom_agg(x::text, 1000, 0.01) from generate_series(1, 10) x);
+
+-- text i/o roundtrip
+select b1::text::hashlib_bloom::text = b1::text from bloom_test;
+
+-- invalid input
+select bloom_agg(x::text, 100, 0.01, 'city64') from generate_series(1, 10) x;
+select bloom_agg(x::text, 0, 0.01) from generate_series(1, 10) x;
+select bloom_agg(x::text, 100, 1) from generate_series(1, 10) x;
+select '\x02'::hashlib_bloom;
+select '\x0204000010000000636974793132380000000000000000005dd2'::hashlib_bloom;
+select '\x0104000011000000636974793132380000000000000000005dd2'::hashlib_bloom;
+
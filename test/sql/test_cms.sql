@@ -0,0 +1,38 @@
+
+-- estimates
+select cms_estimate(cms_agg((x % 10)::text, 1000, 4), '3'::text) from generate_series(1, 1000) x;
+select cms_estimate(cms_agg((x % 10)::text, 1000, 4), '11'::text) from generate_series(1, 1000) x;
+select cms_estimate(cms_agg((x % 10)::text::bytea, 1000, 4, 'city128'), '3'::bytea) from generate_series(1, 1000) x;
+
+-- small sketch overestimates, never underestimates
+select cms_estimate(cms_agg(x::text, 50, 3), '42'::text) from generate_series(1, 10000) x;
+select bool_and(cms_estimate(s, x::text) >= 1)
+  from (select cms_agg(x::text, 50, 3) as s from generate_series(1, 10000) x) t, generate_series(1, 10000) x;
+
+-- heavy hitters
+create temp table cms_test as
+  select x::text as val from generate_series(1, 1000) x, generate_series(1, 1000 / x);
+select * from cms_top((select cms_agg(val, 1000, 4, 'city128', 5) from cms_test));
+select * from cms_top((select cms_agg(val, 1000, 4) from cms_test));
+select * from cms_top((select cms_agg('a'::bytea, 100, 2, 'city128', 3)));
+
+-- merging
+select cms_estimate(cms_union(a, b), '1'::text), cms_estimate(cms_union(a, b), '7'::text)
+  from (select cms_agg(val, 1000, 4) as a from cms_test where val::int % 2 = 0) t1,
+       (select cms_agg(val, 1000, 4) as b from cms_test where val::int % 2 = 1) t2;
+select * from cms_top(cms_union((select cms_agg(val, 1000, 4, 'city128', 3) from cms_test where val < '3'),
+                                (select cms_agg(val, 1000, 4, 'city128', 3) from cms_test where val >= '3')));
+
+-- empty input
+select cms_agg(x, 100, 2) is null from (select ''::text as x where false) t;
+
+-- text i/o
+select cms_agg('a'::text, 2, 1, 'city128', 1);
+select cms_agg('a'::text, 2, 1, 'city128', 1)::text::cms::text = cms_agg('a'::text, 2, 1, 'city128', 1)::text;
+
+-- errors
+select cms_agg('a'::text, 100, 0);
+select cms_agg('a'::text, 100, 2, 'city64');
+select cms_agg('a'::text, 100, 2, 'city128', 2000);
+select cms_union(cms_agg('a'::text, 100, 2), cms_agg('a'::text, 100, 3));
+select '\x02'::cms;
@@ -0,0 +1,8 @@
+-- CRC of concatenation from CRCs of chunks
+
+select crc32_combine(hash_string('abc', 'crc32'), hash_string('defg', 'crc32'), 4) = hash_string('abcdefg', 'crc32');
+select crc32c_combine(hash_string('12345', 'crc32c'), hash_string('6789', 'crc32c'), 4);
+select crc32_combine(hash_string('abc', 'crc32'), 0, 0) = hash_string('abc', 'crc32');
+select crc32c_combine(hash_string(repeat('0123456789abcdef', 600), 'crc32c'), hash_string(repeat('0123456789abcdef', 1000), 'crc32c'), 16000)
+       = hash_string(repeat('0123456789abcdef', 1600), 'crc32c');
+select crc32_combine(1, 2, -1);
@@ -4,6 +4,20 @@ select hash_string('a', 'crc32');
 select hash_string('abcdefg', 'crc32');
 select hash_string('defg', 'crc32', hash_string('abc', 'crc32'));
 select encode(hash128_string('abcdefg', 'crc32'), 'hex');
+select hash_string(repeat('0123456789abcdef', 4), 'crc32');
+select hash_string(repeat('0123456789abcdef', 4) || 'x', 'crc32');
+select hash_string(repeat('0123456789abcdef', 100) || 'xyz', 'crc32');
+select hash_string(repeat('0123456789abcdef', 100), 'crc32', hash_string(repeat('0123456789abcdef', 100), 'crc32'))
+       = hash_string(repeat('0123456789abcdef', 200), 'crc32');
+select hash_string('', 'crc32c');
+select hash_string('a', 'crc32c');
+select hash_string('123456789', 'crc32c');
+select hash_string('6789', 'crc32c', hash_string('12345', 'crc32c'));
+select encode(hash128_string('123456789', 'crc32c'), 'hex');
+select hash_string(repeat('0123456789abcdef', 100) || 'xyz', 'crc32c');
+select hash_string(repeat('0123456789abcdef', 1600), 'crc32c');
+select hash_string(repeat('0123456789abcdef', 1000), 'crc32c', hash_string(repeat('0123456789abcdef', 600), 'crc32c'))
+       = hash_string(repeat('0123456789abcdef', 1600), 'crc32c');
 
 select hash_string('', 'lookup2');
 select hash_string('a', 'lookup2');
@@ -35,6 +49,22 @@ select hash_string('', 'murmur3');
 select hash_string('a', 'murmur3');
 select hash_string('abcdefg', 'murmur3');
 select encode(hash128_string('abcdefg', 'murmur3'), 'hex');
+select hash_string('abcdefg', 'murmur3_128');
+select hash64_string('abcdefg', 'murmur3_128');
+select encode(hash128_string('', 'murmur3_128'), 'hex');
+select encode(hash128_string('a', 'murmur3_128'), 'hex');
+select encode(hash128_string('abcdefg', 'murmur3_128'), 'hex');
+select encode(hash128_string('0123456789abcdef', 'murmur3_128'), 'hex');
+select encode(hash128_string(repeat('0123456789abcdef', 4) || 'abcdefghijklmno', 'murmur3_128'), 'hex');
+select encode(hash128_string('abcdefg', 'murmur3_128', 42, 42), 'hex');
+select hash_string('abcdefg', 'murmur3_x86_128');
+select hash64_string('abcdefg', 'murmur3_x86_128');
+select encode(hash128_string('', 'murmur3_x86_128'), 'hex');
+select encode(hash128_string('a', 'murmur3_x86_128'), 'hex');
+select encode(hash128_string('abcdefg', 'murmur3_x86_128'), 'hex');
+select encode(hash128_string('0123456789abcdef', 'murmur3_x86_128'), 'hex');
+select encode(hash128_string(repeat('0123456789abcdef', 4) || 'abcdefghijklmno', 'murmur3_x86_128'), 'hex');
+select encode(hash128_string('abcdefg', 'murmur3_x86_128', 180388626474, 180388626474), 'hex');
 
 select hash_string('', 'pgsql84');
 select hash_string('a', 'pgsql84');
@@ -91,6 +121,56 @@ select hash64_string('0123456789abcdef0123456789abcdef0123456789abcdef0123456789
 select hash64_string('0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef', 'spooky');
 select hash64_string('0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef0', 'spooky');
 
+select hash64_string('', 'siphash24', 506097522914230528, 1084818905618843912);
+select hash64_string('', 'siphash13', 506097522914230528, 1084818905618843912);
+select hash64_string('abcdefg', 'siphash13');
+select hash64_string('abcdefg', 'siphash13', 506097522914230528, 1084818905618843912);
+select hash64_string(repeat('0123456789abcdef', 4) || 'x', 'siphash13');
+select encode(hash128_string('', 'siphash24_128', 506097522914230528, 1084818905618843912), 'hex');
+select encode(hash128_string('abcdefg', 'siphash24_128'), 'hex');
+select encode(hash128_string(repeat('0123456789abcdef', 4) || 'x', 'siphash24_128', 506097522914230528, 1084818905618843912), 'hex');
+select hash64_string('', 'halfsiphash13', 506097522914230528);
+select hash_string('abcdefg', 'halfsiphash13');
+select hash64_string('abcdefg', 'halfsiphash13', 506097522914230528);
+select hash_string(repeat('0123456789abcdef', 4) || 'x', 'halfsiphash13');
+
+select hash64_string('', 'xxh64');
+select hash64_string('a', 'xxh64');
+select hash64_string('abcdefg', 'xxh64');
+select hash64_string('abcdefg', 'xxh64', 42);
+select hash_string('abcdefg', 'xxh64');
+select hash64_string('0123456789abcdef0123456789abcde', 'xxh64');
+select hash64_string('0123456789abcdef0123456789abcdef', 'xxh64');
+select hash64_string('0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef0', 'xxh64');
+
+select hash64_string('', 'xxh3_64');
+select hash64_string('a', 'xxh3_64');
+select hash64_string('abc', 'xxh3_64');
+select hash64_string('abcdefg', 'xxh3_64');
+select hash64_string('abcdefg', 'xxh3_64', 42);
+select hash64_string('0123456789abcdef', 'xxh3_64');
+select hash64_string('0123456789abcdef0', 'xxh3_64');
+select hash64_string('0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef0', 'xxh3_64');
+select hash64_string(repeat('0123456789abcdef', 8), 'xxh3_64');
+select hash64_string(repeat('0123456789abcdef', 8) || 'x', 'xxh3_64');
+select hash64_string(repeat('0123456789abcdef', 15), 'xxh3_64');
+select hash64_string(repeat('0123456789abcdef', 15) || 'x', 'xxh3_64');
+select hash64_string(repeat('0123456789abcdef', 15) || 'x', 'xxh3_64', 42);
+select hash64_string(repeat('0123456789abcdef', 100), 'xxh3_64');
+select hash64_string(repeat('0123456789abcdef', 100), 'xxh3_64', -1);
+
+select encode(hash128_string('', 'xxh3_128'), 'hex');
+select encode(hash128_string('a', 'xxh3_128'), 'hex');
+select encode(hash128_string('abcdefg', 'xxh3_128'), 'hex');
+select encode(hash128_string('abcdefg', 'xxh3_128', 42), 'hex');
+select encode(hash128_string('0123456789abcdef', 'xxh3_128'), 'hex');
+select encode(hash128_string('0123456789abcdef0', 'xxh3_128'), 'hex');
+select encode(hash128_string(repeat('0123456789abcdef', 8) || 'x', 'xxh3_128'), 'hex');
+select encode(hash128_string(repeat('0123456789abcdef', 15) || 'x', 'xxh3_128'), 'hex');
+select encode(hash128_string(repeat('0123456789abcdef', 100), 'xxh3_128'), 'hex');
+select encode(hash128_string(repeat('0123456789abcdef', 100), 'xxh3_128', 42), 'hex');
+select hash64_string('abcdefg', 'xxh3_128') = hash64_string('abcdefg', 'xxh3_128', 0);
+
 SELECT encode(hash128_string('', 'md5'), 'hex');
 -- d41d8cd98f00b204e9800998ecf8427e
 SELECT encode(hash128_string('a', 'md5'), 'hex');
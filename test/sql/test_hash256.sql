@@ -0,0 +1,12 @@
+-- CityHash crc variants: 128-bit and 256-bit output
+
+select hash128_string('abcdefg', 'citycrc128') = hash128_string('abcdefg', 'city128');
+select hash128_string(repeat('0123456789abcdef', 56), 'citycrc128', 5, 7) = hash128_string(repeat('0123456789abcdef', 56), 'city128', 5, 7);
+select encode(hash128_string(repeat('0123456789abcdef', 100), 'citycrc128'), 'hex');
+select encode(hash128_string(repeat('0123456789abcdef', 100), 'citycrc128', 5, 7), 'hex');
+select encode(hash256_string('', 'citycrc256'), 'hex');
+select encode(hash256_string('abcdefg', 'citycrc256'), 'hex');
+select encode(hash256_string(repeat('0123456789abcdef', 15), 'citycrc256'), 'hex');
+select encode(hash256_string(repeat('0123456789abcdef', 100), 'citycrc256'), 'hex');
+select substr(hash256_string('abcdefg', 'citycrc256'), 1, 16) = hash128_string('abcdefg', 'citycrc256');
+select hash256_string('abcdefg', 'city128');
@@ -0,0 +1,39 @@
+
+-- estimates
+select round(hll_cardinality(hll_add_agg(x::text, 'city64', 12))) from generate_series(1, 1000) x;
+select round(hll_cardinality(hll_add_agg(x::text, 'murmur3', 14))) from generate_series(1, 100000) x;
+select round(hll_cardinality(hll_add_agg(x::text::bytea, 'spooky', 10))) from generate_series(1, 100000) x;
+select round(hll_cardinality(hll_add_agg(x::text, 'city64', 4))) from generate_series(1, 10000) x;
+
+-- duplicates and nulls do not count
+select round(hll_cardinality(hll_add_agg(nullif(x % 10, 0)::text, 'city64', 12))) from generate_series(1, 1000) x;
+
+-- sparse at low cardinality, dense later
+select get_byte(hll_send(hll_add_agg(x::text, 'city64', 12)), 1) from generate_series(1, 10) x;
+select get_byte(hll_send(hll_add_agg(x::text, 'city64', 12)), 1) from generate_series(1, 10000) x;
+select octet_length(hll_send(hll_add_agg(x::text, 'city64', 12))) from generate_series(1, 10000) x;
+
+-- merging
+create temp table hll_test as
+  select x / 500 as day, hll_add_agg(x::text, 'city64', 12) as h
+    from generate_series(1, 999) x group by 1;
+select round(hll_cardinality(hll_union_agg(h))) from hll_test;
+select round(hll_cardinality(hll_union(a.h, b.h))) from hll_test a, hll_test b where a.day = 0 and b.day = 1;
+select round(hll_cardinality(hll_union_agg(h)))
+       = (select round(hll_cardinality(hll_add_agg(x::text, 'city64', 12))) from generate_series(1, 999) x)
+  from hll_test;
+
+-- empty input
+select hll_add_agg(x, 'city64', 12) is null from (select ''::text as x where false) t;
+select hll_union_agg(h) is null from (values (null::hll), (null::hll)) v(h);
+select hll_cardinality(hll_add_agg(x, 'city64', 12)) from (select null::text as x) t;
+
+-- text i/o
+select hll_add_agg(x::text, 'city64', 4) from generate_series(1, 3) x;
+select bool_and(h::text::hll::text = h::text) from hll_test;
+
+-- errors
+select hll_add_agg(x::text, 'city64', 3) from generate_series(1, 3) x;
+select hll_union(a.h, b.h) from hll_test a, (select hll_add_agg('x'::text, 'city64', 10) as h) b where a.day = 0;
+select '\x01'::hll;
+
@@ -0,0 +1,24 @@
+
+create temp table lo_test as
+  select id, lo_from_bytea(0, data) as lo, data
+    from (values (1, ''::bytea),
+                 (2, 'abc'::bytea),
+                 (3, convert_to(repeat('0123456789', 100000), 'UTF8'))) v(id, data);
+
+-- same result as hashing whole value
+select id, hash_lo(lo, 'crc32') = hash_string(data, 'crc32'),
+       hash_lo(lo, 'murmur3', 5) = hash_string(data, 'murmur3', 5),
+       hash64_lo(lo, 'siphash24') = hash64_string(data, 'siphash24'),
+       hash64_lo(lo, 'siphash24', 1, 2) = hash64_string(data, 'siphash24', 1, 2),
+       hash128_lo(lo, 'md5') = hash128_string(data, 'md5'),
+       hash128_lo(lo, 'spooky', 7) = hash128_string(data, 'spooky', 7)
+  from lo_test order by id;
+
+-- algorithm must support incremental hashing
+select hash64_lo(lo, 'city64') from lo_test where id = 1;
+
+-- missing object
+select hash_lo(0, 'crc32');
+
+select count(lo_unlink(lo)) from lo_test;
+
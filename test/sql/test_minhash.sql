@@ -0,0 +1,42 @@
+
+-- signatures
+select minhash(array['a', 'b', 'c'], 4);
+select minhash(array['a', 'b', 'c'], 4, 'murmur3');
+select minhash(array['a', 'b', 'c']::bytea[], 4, 'city64') = minhash(array['a', 'b', 'c'], 4);
+
+-- slot i is minimum of seeded hash
+select minhash(array['a', 'b', 'c'], 100, 'murmur3')
+       = array(select (select min(hash64_string(v, 'murmur3', s)) from unnest(array['a', 'b', 'c']) v)
+                 from generate_series(1, 100) s order by s);
+
+-- order, duplicates and nulls do not matter
+select minhash(array['c', null, 'a', 'b', 'a'], 16) = minhash(array['a', 'b', 'c'], 16);
+select minhash(array[null]::text[], 16) is null;
+
+-- aggregate gives same result
+select minhash_agg(x::text, 64, 'city64') = minhash(array_agg(x::text), 64, 'city64')
+  from generate_series(1, 1000) x;
+select minhash_agg(x::text::bytea, 64, 'murmur3') = minhash(array_agg(x::text), 64, 'murmur3')
+  from generate_series(1, 1000) x;
+select minhash_agg(x, 64, 'city64') is null from (select ''::text as x where false) t;
+select minhash_agg(x, 16, 'city64') is null from (values (null::text), (null::text)) t(x);
+
+-- similarity, exact jaccard is 1/3
+select round(minhash_similarity(
+         (select minhash_agg(x::text, 256, 'city64') from generate_series(1, 1000) x),
+         (select minhash_agg(x::text, 256, 'city64') from generate_series(501, 1500) x))::numeric, 2);
+select minhash_similarity(minhash(array['a', 'b'], 32), minhash(array['b', 'a'], 32));
+select minhash_similarity(minhash(array['a'], 32), minhash(array['b'], 32));
+
+-- bands
+select minhash_bands(minhash(array['a', 'b', 'c'], 4), 2, 2);
+select minhash_bands(minhash(array['a', 'b', 'c'], 16), 4, 4)
+       && minhash_bands(minhash(array['a', 'b', 'c', 'd'], 16), 4, 4);
+select minhash_bands(minhash(array['a', 'b', 'c'], 16), 4, 4)
+       && minhash_bands(minhash(array['x', 'y', 'z'], 16), 4, 4);
+
+-- errors
+select minhash(array['a'], 0);
+select minhash(array['a'], 4, 'md5');
+select minhash_bands(minhash(array['a'], 4), 3, 2);
+select minhash_similarity(minhash(array['a'], 4), minhash(array['a'], 8));
@@ -0,0 +1,47 @@
+-- support functions match generic functions
+select hashlib_hashtext_city64('hello') = hash_string('hello', 'city64');
+select hashlib_hashtext_city64_extended('hello', 0) = hash64_string('hello', 'city64');
+select hashlib_hashtext_city64_extended('hello', 42) = hash64_string('hello', 'city64', 42);
+select hashlib_hashbytea_murmur3('hello') = hash_string('hello'::bytea, 'murmur3_128');
+select hashlib_hashbytea_murmur3_extended('hello', 0) = hash64_string('hello'::bytea, 'murmur3_128');
+select hashlib_hashbytea_murmur3_extended('hello', 42) = hash64_string('hello'::bytea, 'murmur3_128', 42);
+select hashlib_hashbytea_murmur3_extended('hello', 1) <> hashlib_hashbytea_murmur3_extended('hello', 4294967297);
+select hashlib_hashint8_wang64(12345) = hash_int8(12345, 'wang64')::bit(32)::int4;
+select hashlib_hashint8_wang64_extended(12345, 0) = hash_int8(12345, 'wang64');
+
+-- hash index
+create table opc_idx (k text, b bytea, i int8);
+insert into opc_idx select x::text, x::text::bytea, x from generate_series(1, 1000) x;
+create index opc_idx_k on opc_idx using hash (k text_city64_ops);
+create index opc_idx_b on opc_idx using hash (b bytea_murmur3_ops);
+create index opc_idx_i on opc_idx using hash (i int8_wang64_ops);
+set enable_seqscan = off;
+select * from opc_idx where k = '500';
+select * from opc_idx where b = '777'::bytea;
+select * from opc_idx where i = 42;
+reset enable_seqscan;
+
+-- hash partitioning
+create table opc_part (k text) partition by hash (k text_city64_ops);
+create table opc_part0 partition of opc_part for values with (modulus 4, remainder 0);
+create table opc_part1 partition of opc_part for values with (modulus 4, remainder 1);
+create table opc_part2 partition of opc_part for values with (modulus 4, remainder 2);
+create table opc_part3 partition of opc_part for values with (modulus 4, remainder 3);
+insert into opc_part select x::text from generate_series(1, 1000) x;
+select tableoid::regclass as part, count(*) from opc_part group by 1 order by 1;
+
+-- partition can be computed outside of database
+select bool_and(tableoid::regclass::text = 'opc_part'
+                || ((hash64_string(k, 'city64', 8816678312871386365)::numeric
+                     + 5305509591434766563 + 18446744073709551616) % 18446744073709551616 % 4))
+  from opc_part;
+
+create table opc_ipart (k int8) partition by hash (k int8_wang64_ops);
+create table opc_ipart0 partition of opc_ipart for values with (modulus 4, remainder 0);
+create table opc_ipart1 partition of opc_ipart for values with (modulus 4, remainder 1);
+create table opc_ipart2 partition of opc_ipart for values with (modulus 4, remainder 2);
+create table opc_ipart3 partition of opc_ipart for values with (modulus 4, remainder 3);
+insert into opc_ipart select x from generate_series(1, 1000) x;
+select tableoid::regclass as part, count(*) from opc_ipart group by 1 order by 1;
+
+drop table opc_idx, opc_part, opc_ipart;
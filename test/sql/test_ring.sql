@@ -0,0 +1,34 @@
+-- lookup
+select ring_lookup(ring_build(array['a', 'b', 'c'], 100, 'city64'), k) from unnest(array['user1', 'user2', 'user3', 'hello']) k;
+select ring_lookup(ring_build(array['a', 'b', 'c'], 10, 'murmur3'), k) from unnest(array['user1', 'user2', 'user3', 'hello']) k;
+select ring_lookup(ring_build(array['a', 'b', 'c'], 100, 'city64'), 'user1'::bytea) = 'b';
+select ring_lookup(ring_build(array['a', 'b', 'c'], 100, 'city64'), k::text) as node, count(*)
+  from generate_series(1, 9000) k group by 1 order by 1;
+
+-- removing node moves only its keys
+select count(*) from generate_series(1, 9000) k
+ where ring_lookup(ring_build(array['a', 'b', 'c'], 100, 'city64'), k::text) <> 'b'
+   and ring_lookup(ring_build(array['a', 'b', 'c'], 100, 'city64'), k::text)
+       <> ring_lookup(ring_build(array['a', 'c'], 100, 'city64'), k::text);
+
+-- text roundtrip
+select ring_build(array['a', 'b', 'c'], 100, 'city64')::text::hashlib_ring::text
+       = ring_build(array['a', 'b', 'c'], 100, 'city64')::text;
+
+-- bounded loads
+select node, count(*) from unnest((select array_agg(ring_lookup(ring_build(array['a', 'b', 'c'], 4, 'city64'), k::text))
+                                     from generate_series(1, 300) k)) node group by 1 order by 1;
+select node, count(*) from unnest(ring_assign(ring_build(array['a', 'b', 'c'], 4, 'city64'),
+                                              (select array_agg(k::text) from generate_series(1, 300) k), 1.1)) node
+ group by 1 order by 1;
+select ring_assign(ring_build(array['a', 'b', 'c'], 100, 'city64'), array['user1', null, 'user2']::text[], 1000);
+select ring_assign(ring_build(array['a', 'b', 'c'], 100, 'city64'), array[]::bytea[], 1.5);
+
+-- errors
+select ring_build(array[]::text[], 10, 'city64');
+select ring_build(array['a', null], 10, 'city64');
+select ring_build(array['a', 'b'], 0, 'city64');
+select ring_assign(ring_build(array['a', 'b'], 10, 'city64'), array['x'], 0.5);
+select ('\x02' || repeat('00', 39))::hashlib_ring;
+select ('\x01' || repeat('00', 39))::hashlib_ring;
+select (left(ring_build(array['a'], 1, 'city64')::text, -2) || '62')::hashlib_ring;
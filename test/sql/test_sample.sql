@@ -0,0 +1,51 @@
+create table smp (id int8, name text);
+insert into smp select x, 'user' || x from generate_series(1, 10000) x;
+
+-- sample size
+select count(*) from smp tablesample hashlib('id', 10, 'wang64');
+select count(*) from smp tablesample hashlib('id', 10, 'wang64to32');
+select count(*) from smp tablesample hashlib('name', 10, 'city64');
+select count(*) from smp tablesample hashlib('name', 10, 'murmur3');
+select count(*) from smp tablesample hashlib('id', 0, 'wang64');
+select count(*) from smp tablesample hashlib('id', 100, 'wang64');
+
+-- row is kept when unsigned hash is under percent of hash range
+select array_agg(id order by id) = (select array_agg(id order by id) from smp
+        where (hash_int8(id, 'wang64')::numeric + 18446744073709551616) % 18446744073709551616
+              < 0.1 * 18446744073709551616)
+  from smp tablesample hashlib('id', 10, 'wang64');
+select array_agg(id order by id) = (select array_agg(id order by id) from smp
+        where (hash64_string(name, 'city64')::numeric + 18446744073709551616) % 18446744073709551616
+              < 0.1 * 18446744073709551616)
+  from smp tablesample hashlib('name', 10, 'city64');
+
+-- sample does not depend on physical order or seed
+create table smp2 as select * from smp order by name desc;
+select array_agg(id order by id) = (select array_agg(id order by id) from smp2 tablesample hashlib('id', 25, 'wang64'))
+  from smp tablesample hashlib('id', 25, 'wang64') repeatable (42);
+
+-- deleted rows are skipped
+delete from smp where id % 2 = 0;
+select array_agg(id order by id) = (select array_agg(id order by id) from smp
+        where (hash_int8(id, 'wang64')::numeric + 18446744073709551616) % 18446744073709551616
+              < 0.1 * 18446744073709551616)
+  from smp tablesample hashlib('id', 10, 'wang64');
+
+-- errors
+select count(*) from smp tablesample hashlib('nope', 10, 'wang64');
+select count(*) from smp tablesample hashlib('id', 101, 'wang64');
+select count(*) from smp tablesample hashlib('id', 10, 'city64');
+select count(*) from smp tablesample hashlib('name', 10, 'wang64');
+select count(*) from smp tablesample hashlib('ctid', 10, 'city64');
+
+-- key column must be readable
+create role regress_hashlib_sample;
+grant select (id) on smp to regress_hashlib_sample;
+set role regress_hashlib_sample;
+select count(*) from smp tablesample hashlib('id', 100, 'wang64');
+select count(*) from smp tablesample hashlib('name', 10, 'city64');
+reset role;
+drop owned by regress_hashlib_sample;
+drop role regress_hashlib_sample;
+
+drop table smp, smp2;
@@ -0,0 +1,61 @@
+
+-- jump hash
+select jump_hash(1, 10), jump_hash(123456789, 1000), jump_hash(-1, 100), jump_hash(42, 1);
+select jump_hash_string('hello', 'city64', 10), jump_hash_string('hello', 'murmur3', 10);
+select jump_hash_string('hello'::bytea, 'city64', 10) = jump_hash(hash64_string('hello', 'city64'), 10);
+select jump_hash(k, 4) as bucket, count(*) from generate_series(1, 10000) k group by 1 order by 1;
+
+-- only keys for new bucket move
+select count(*), min(new_bucket), max(new_bucket) from jump_hash_moves(1, 10000, 10, 11);
+select count(*) from generate_series(1, 10000) k where jump_hash(k, 10) <> jump_hash(k, 11);
+select count(*), min(old_bucket), max(old_bucket) from jump_hash_moves(1, 10000, 11, 10);
+select * from jump_hash_moves(1, 20, 3, 4);
+select * from jump_hash_moves(20, 1, 3, 4);
+
+-- rendezvous
+select rendezvous_pick('user1', array['a', 'b', 'c'], 'city64');
+select rendezvous_pick('user1'::bytea, array['a', 'b', 'c'], null, 'city64');
+select rendezvous_pick(k::text, array['a', 'b', 'c'], 'city64') as node, count(*)
+  from generate_series(1, 9000) k group by 1 order by 1;
+select rendezvous_pick(k::text, array['a', 'b', 'c'], array[1, 2, 1], 'city64') as node, count(*)
+  from generate_series(1, 8000) k group by 1 order by 1;
+select count(*) from generate_series(1, 8000) k
+ where rendezvous_pick(k::text, array['a', 'b', 'c'], array[1, 0, 1], 'city64') = 'b';
+
+-- removing node moves only its keys
+select count(*) from generate_series(1, 9000) k
+ where rendezvous_pick(k::text, array['a', 'b', 'c'], 'city64') <> 'b'
+   and rendezvous_pick(k::text, array['a', 'b', 'c'], 'city64') <> rendezvous_pick(k::text, array['a', 'c'], 'city64');
+
+-- replica sets
+select rendezvous_top('user1', array['a', 'b', 'c', 'd'], 2, 'city64');
+select rendezvous_top('user1', array['a', 'b', 'c'], 5, 'city64');
+select rendezvous_top('user1', array['a', 'b', 'c'], array[1, 0, 1], 3, 'city64');
+select bool_and(rendezvous_top(k::text, array['a', 'b', 'c', 'd'], 1, 'city64')
+                = array[rendezvous_pick(k::text, array['a', 'b', 'c', 'd'], 'city64')])
+  from generate_series(1, 1000) k;
+
+-- multiply-shift buckets
+select hash_bucket('hello', 'city64', 10), hash_bucket('hello', 'murmur3', 10), hash_bucket('hello'::bytea, 'crc32', 10);
+select hash_bucket('hello', 'city64', 1000)
+       = floor((hash64_string('hello', 'city64')::numeric + 18446744073709551616) % 18446744073709551616 * 1000 / 18446744073709551616);
+select hash_bucket('hello', 'murmur3', 1000)
+       = floor((hash_string('hello', 'murmur3')::numeric + 4294967296) % 4294967296 * 1000 / 4294967296);
+select hash_bucket(k::text, 'city64', 4) as bucket, count(*) from generate_series(1, 10000) k group by 1 order by 1;
+select k, hash_int_bucket(k, 'wang64', 100) as wang64, hash_int_bucket(k, 'wang64to32', 100) as wang64to32,
+       hash_int_bucket(k, 'wang32', 100) as wang32, hash_int_bucket(k, 'jenkins', 100) as jenkins
+  from unnest(array[1, 42, -1, 123456789012]) k;
+select hash_int_bucket(k, 'wang32', 4) as bucket, count(*) from generate_series(1, 10000) k group by 1 order by 1;
+
+-- errors
+select jump_hash(1, 0);
+select jump_hash_string('hello', 'city64', -1);
+select * from jump_hash_moves(1, 10, 0, 4);
+select rendezvous_pick('user1', array[]::text[], 'city64');
+select rendezvous_pick('user1', array['a', null], 'city64');
+select rendezvous_pick('user1', array['a', 'b'], array[1], 'city64');
+select rendezvous_pick('user1', array['a', 'b'], array[1, -1], 'city64');
+select rendezvous_pick('user1', array['a', 'b'], array[0, 0], 'city64');
+select rendezvous_top('user1', array['a', 'b'], 0, 'city64');
+select hash_bucket('hello', 'city64', 0);
+select hash_int_bucket(1, 'city64', 10);
@@ -0,0 +1,15 @@
+
+-- per-algorithm entry points must match generic dispatchers
+
+select hashlib_crc32('abcdefg') = hash_string('abcdefg', 'crc32');
+select hashlib64_lookup2('abcdefg') = hash64_string('abcdefg', 'lookup2');
+select hashlib64_city64('0123456789abcdef0') = hash64_string('0123456789abcdef0', 'city64');
+select hashlib128_md5('abc') = hash128_string('abc', 'md5');
+select hashlib128_spooky('abcdefg') = hash128_string('abcdefg', 'spooky');
+select hashlib_int4_jenkins(12345678) = hash_int4(12345678, 'jenkins');
+select hashlib_int4_wang32(1234567890123456789::int8) = hash_int4(1234567890123456789::int8, 'wang32');
+select hashlib_int8_wang64(12345678) = hash_int8(12345678, 'wang64');
+
+-- rewritten calls give same results as non-constant names
+select count(*) from (select x::text as s, 'city64'::text as a from generate_series(1, 100) x) t
+ where hash64_string(s, 'city64') <> hash64_string(s, a);
@@ -0,0 +1,35 @@
+
+create temp table toast_test (id int4, ext text, cmp text);
+alter table toast_test alter column ext set storage external;
+insert into toast_test
+  select id, d, d
+    from (values (1, repeat('0123456789abcdef', 100000)),
+                 (2, repeat(md5('x'), 40000) || repeat('y', 12345))) v(id, d);
+
+-- first stored uncompressed out-of-line, second compressed
+select id, pg_column_size(ext) = octet_length(ext), pg_column_size(cmp) < octet_length(cmp)
+  from toast_test order by id;
+
+-- streamed in pieces, same result as hashing whole value
+select id, hash_string(ext, 'crc32') = hash_string(ext || '', 'crc32'),
+       hash_string(cmp, 'crc32') = hash_string(cmp || '', 'crc32'),
+       hash64_string(ext, 'siphash24', 1, 2) = hash64_string(ext || '', 'siphash24', 1, 2),
+       hash64_string(cmp, 'siphash24', 1, 2) = hash64_string(cmp || '', 'siphash24', 1, 2),
+       hash128_string(ext, 'md5') = hash128_string(ext || '', 'md5'),
+       hash128_string(cmp, 'spooky') = hash128_string(cmp || '', 'spooky')
+  from toast_test order by id;
+
+-- per-algorithm functions
+select id, hashlib_murmur3(ext::bytea) = hash_string(ext || '', 'murmur3'),
+       hashlib128_md5(cmp::bytea) = hash128_string(cmp || '', 'md5')
+  from toast_test order by id;
+
+-- aggregates
+select id, hash128_string_agg(cmp, 'md5') = hash128_string(min(cmp || ''), 'md5'),
+       hashlib_fingerprint(ext, 'spooky') = hash128_string(min(ext || ''), 'spooky')
+  from toast_test group by id order by id;
+
+-- algorithms without streaming detoast fully
+select id, hash64_string(ext, 'city64') = hash64_string(ext || '', 'city64')
+  from toast_test order by id;
+